@@ -0,0 +1,197 @@
+// Measurements of the benchmark firmware (main.cpp) and the on-device
+// tests in test/test_embedded
+
+#include "Bench.hpp"
+
+#include "Controller.hpp"
+#include "LightService.hpp"
+#include "SpeakerService.hpp"
+#include "SensorService.hpp"
+
+#include "StaticMode.hpp"
+#include "WaveMode.hpp"
+#include "BlinkMode.hpp"
+#include "HalfMode.hpp"
+#include "CenterMode.hpp"
+#include "ChaseMode.hpp"
+
+#include "FrameStats.hpp"
+#include "BenchSensorInput.hpp"
+#include "CountingLedDriver.hpp"
+
+// Counts the donations the Controller reports
+class DonationCounter : public ControllerObserver {
+  public:
+    uint32_t count = 0;
+    void onDonation(uint8_t modeIndex, unsigned long timestampMs) override { count++; }
+};
+
+DonationCounter detectedDonations;
+
+CountingLedDriver ledDriver;
+LightService* lightService;
+SpeakerService* speakerService;
+SensorService* sensorService;
+BenchSensorInput sensorInput;
+AbstractMode* modes[BENCH_MODE_COUNT];
+
+uint32_t renderSamples[BENCH_FRAMES];
+uint32_t showSamples[BENCH_FRAMES];
+uint32_t latencySamples[BENCH_DONATIONS];
+FrameStats renderStats(renderSamples, BENCH_FRAMES);
+FrameStats showStats(showSamples, BENCH_FRAMES);
+FrameStats latencyStats(latencySamples, BENCH_DONATIONS);
+
+// Budget violations of the current mode, reset per mode
+uint32_t slowFrames = 0;
+uint32_t extraShows = 0;
+
+// Render frames back to back with a synthetic clock, a donation halfway
+void benchRender(AbstractMode* mode) {
+  const unsigned long interval = 1000 / TARGET_FPS;
+  
+  mode->activate();
+  unsigned long now = millis();
+  
+  for (uint16_t frame = 0; frame < BENCH_FRAMES; frame++) {
+    if (frame == BENCH_FRAMES / 2) {
+      mode->donationTriggered();
+    }
+    now += interval;
+    
+    lightService->beginFrame();
+    uint32_t start = micros();
+    mode->renderFrame(now, interval);
+    uint32_t rendered = micros();
+    bool shown = lightService->commitFrame();
+    uint32_t end = micros();
+    
+    renderStats.add(rendered - start);
+    if (shown) {
+      showStats.add(end - rendered);
+    }
+    if (end - start > BENCH_MAX_FRAME_US) {
+      slowFrames++;
+    }
+    yield();
+  }
+  
+  // Start the latency test from the idle animation
+  if (mode->isDonationEffectActive()) {
+    mode->endDonationEffect();
+  }
+}
+
+// One iteration of the firmware loop without the network part
+bool loopOnce(Controller& controller) {
+  uint32_t showsBefore = ledDriver.getShows();
+  lightService->beginFrame();
+  sensorService->loop();
+  controller.loop();
+  bool shown = lightService->commitFrame();
+  // Writes outside beginFrame()/commitFrame() would push extra frames
+  if (ledDriver.getShows() - showsBefore > 1) {
+    extraShows++;
+  }
+  return shown;
+}
+
+void runFor(Controller& controller, unsigned long ms) {
+  unsigned long start = millis();
+  while (millis() - start < ms) {
+    loopOnce(controller);
+    yield();
+  }
+}
+
+// Full pipeline: sensor edge -> Controller -> mode -> strip
+void benchLatency(AbstractMode* mode) {
+  AbstractMode* const single[] = {mode};
+  Controller controller(sensorService, speakerService, single);
+  controller.addObserver(&detectedDonations);
+  
+  lightService->beginFrame();
+  controller.setup();
+  lightService->commitFrame();
+  
+  for (uint8_t coin = 0; coin < BENCH_DONATIONS; coin++) {
+    // Let the previous effect end, a coin during it would only extend it
+    runFor(controller, coin == 0 ? 100 : mode->getEffectDuration() + 100);
+    
+    uint32_t before = detectedDonations.count;
+    sensorInput.set(LOW);
+    uint32_t edgeUs = micros();
+    
+    while (micros() - edgeUs < BENCH_TIMEOUT_MS * 1000UL) {
+      bool shown = loopOnce(controller);
+      if (shown && detectedDonations.count != before) {
+        latencyStats.add(micros() - edgeUs);
+        break;
+      }
+      yield();
+    }
+    
+    runFor(controller, BENCH_COIN_MS);
+    sensorInput.set(HIGH);
+  }
+  runFor(controller, mode->getEffectDuration() + 100);
+}
+
+void printStats(const char* label, FrameStats& stats) {
+  Serial.printf("  %-13s n=%-4u min=%-6lu mean=%-6lu p99=%-6lu max=%lu us\n", label,
+                stats.size(), (unsigned long)stats.min(), (unsigned long)stats.mean(),
+                (unsigned long)stats.percentile(99), (unsigned long)stats.max());
+}
+
+// Prints the budget line of one mode
+void checkBudgets(uint32_t heapBefore, BenchResult& result) {
+  // Rendering allocates nothing, a drop here is a leak in the loop
+  int32_t heapLost = (int32_t)heapBefore - (int32_t)ESP.getFreeHeap();
+  result.slowFrames = slowFrames;
+  result.extraShows = extraShows;
+  result.coinsShown = latencyStats.size();
+  result.maxLatencyUs = latencyStats.size() > 0 ? latencyStats.max() : 0;
+  result.heapLost = max(heapLost, (int32_t)0);
+  bool slowEdge = result.coinsShown < BENCH_DONATIONS || result.maxLatencyUs > BENCH_MAX_LATENCY_US;
+  
+  Serial.printf("  budget        %s: %lu slow frames (> %lu us), %lu extra shows, edge->frame %s, heap %ld bytes lost\n",
+                result.passed() ? "ok" : "FAIL", (unsigned long)slowFrames, (unsigned long)BENCH_MAX_FRAME_US,
+                (unsigned long)extraShows, slowEdge ? "too slow" : "ok", (long)result.heapLost);
+}
+
+void benchSetup() {
+  // Speaker stays uninitialized, playback calls return right away
+  lightService = new LightService(&ledDriver);
+  speakerService = new SpeakerService();
+  sensorService = new SensorService(&sensorInput);
+  
+  lightService->setup();
+  sensorService->setup();
+  
+  modes[0] = new StaticMode(lightService, speakerService);
+  modes[1] = new WaveMode(lightService, speakerService);
+  modes[2] = new BlinkMode(lightService, speakerService);
+  modes[3] = new HalfMode(lightService, speakerService);
+  modes[4] = new CenterMode(lightService, speakerService);
+  modes[5] = new ChaseMode(lightService, speakerService);
+}
+
+void benchMode(uint8_t index, BenchResult& result) {
+  renderStats.reset();
+  showStats.reset();
+  latencyStats.reset();
+  slowFrames = 0;
+  extraShows = 0;
+  
+  // The first pass of a mode may set up lazily, the heap is compared after it
+  benchRender(modes[index]);
+  uint32_t heapBefore = ESP.getFreeHeap();
+  benchLatency(modes[index]);
+  
+  result.name = modes[index]->getName();
+  Serial.printf("[BENCH] %s\n", result.name);
+  printStats("render", renderStats);
+  printStats("show", showStats);
+  printStats("edge->frame", latencyStats);
+  checkBudgets(heapBefore, result);
+}
@@ -0,0 +1,45 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <Arduino.h>
+
+#include "Config.h"
+
+#ifndef BENCH_FRAMES
+#define BENCH_FRAMES      300  // Rendered frames per mode
+#endif
+#ifndef BENCH_DONATIONS
+#define BENCH_DONATIONS   3    // Simulated coins per mode for the latency test
+#endif
+#ifndef BENCH_MAX_FRAME_US
+#define BENCH_MAX_FRAME_US (1000000UL / TARGET_FPS) // Render + show of one frame, longer drops frames
+#endif
+#ifndef BENCH_MAX_LATENCY_US
+#define BENCH_MAX_LATENCY_US (2 * 1000000UL / TARGET_FPS) // Sensor edge to the first frame of its effect
+#endif
+#define BENCH_COIN_MS     80   // How long a coin stays in front of the sensor
+#define BENCH_TIMEOUT_MS  1000 // Give up waiting for a frame after a coin
+#define BENCH_MODE_COUNT  6
+
+// Budgets of one mode, filled by benchMode()
+struct BenchResult {
+    const char* name;
+    uint32_t slowFrames;   // Render + show over BENCH_MAX_FRAME_US
+    uint32_t extraShows;   // Passes with more than one driver show
+    uint16_t coinsShown;   // Coins on the strip within BENCH_TIMEOUT_MS, of BENCH_DONATIONS
+    uint32_t maxLatencyUs; // Slowest sensor edge to frame
+    int32_t heapLost;      // Free heap lost over the latency run (0 if none)
+
+    bool passed() const {
+        return slowFrames == 0 && extraShows == 0 && coinsShown == BENCH_DONATIONS &&
+               maxLatencyUs <= BENCH_MAX_LATENCY_US && heapLost == 0;
+    }
+};
+
+// Creates the services and the BENCH_MODE_COUNT modes, once from setup()
+void benchSetup();
+
+// Runs the render and latency measurements of one mode and prints them
+void benchMode(uint8_t index, BenchResult& result);
+
+#endif // BENCH_HPP
@@ -0,0 +1,19 @@
+#ifndef BENCH_SENSOR_INPUT_HPP
+#define BENCH_SENSOR_INPUT_HPP
+
+#include "SensorInput.hpp"
+
+// Sensor the benchmark drives itself, SensorService polls it from loop()
+class BenchSensorInput : public SensorInput {
+    private:
+        uint8_t level = HIGH;
+
+    public:
+        void set(uint8_t newLevel) { level = newLevel; }
+
+        void begin() override { level = HIGH; }
+        uint8_t read() override { return level; }
+        bool attachChangeHandler(LevelHandler handler) override { (void)handler; return false; }
+};
+
+#endif // BENCH_SENSOR_INPUT_HPP
@@ -0,0 +1,17 @@
+#ifndef COUNTING_LED_DRIVER_HPP
+#define COUNTING_LED_DRIVER_HPP
+
+#include "FastLedDriver.hpp"
+
+// The real strip driver, counting how often it pushes a frame
+class CountingLedDriver : public FastLedDriver {
+    private:
+        uint32_t shows = 0;
+
+    public:
+        void show() override { shows++; FastLedDriver::show(); }
+
+        uint32_t getShows() const { return shows; }
+};
+
+#endif // COUNTING_LED_DRIVER_HPP
@@ -0,0 +1,55 @@
+#include "FrameStats.hpp"
+
+void FrameStats::add(uint32_t value) {
+    if (count < capacity) {
+        samples[count++] = value;
+        sorted = false;
+    }
+}
+
+void FrameStats::sort() {
+    if (sorted) {
+        return;
+    }
+    // Insertion sort, a few hundred samples and no heap
+    for (uint16_t i = 1; i < count; i++) {
+        uint32_t value = samples[i];
+        uint16_t j = i;
+        while (j > 0 && samples[j - 1] > value) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = value;
+    }
+    sorted = true;
+}
+
+uint32_t FrameStats::min() {
+    sort();
+    return count ? samples[0] : 0;
+}
+
+uint32_t FrameStats::max() {
+    sort();
+    return count ? samples[count - 1] : 0;
+}
+
+uint32_t FrameStats::mean() const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t sum = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    return sum / count;
+}
+
+uint32_t FrameStats::percentile(uint8_t percent) {
+    if (count == 0) {
+        return 0;
+    }
+    sort();
+    uint16_t index = ((uint32_t)count * percent) / 100;
+    return samples[index < count ? index : count - 1];
+}
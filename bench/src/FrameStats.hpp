@@ -0,0 +1,29 @@
+#ifndef FRAME_STATS_HPP
+#define FRAME_STATS_HPP
+
+#include <Arduino.h>
+
+// Fixed-size sample set with min/mean/p99/max
+class FrameStats {
+    private:
+        uint32_t* samples;
+        uint16_t capacity;
+        uint16_t count = 0;
+        bool sorted = false;
+
+        void sort();
+
+    public:
+        FrameStats(uint32_t* storage, uint16_t capacity) : samples(storage), capacity(capacity) {}
+
+        void reset() { count = 0; sorted = false; }
+        void add(uint32_t value);
+
+        uint16_t size() const { return count; }
+        uint32_t min();
+        uint32_t max();
+        uint32_t mean() const;
+        uint32_t percentile(uint8_t percent);
+};
+
+#endif // FRAME_STATS_HPP
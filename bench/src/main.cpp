@@ -0,0 +1,53 @@
+// Benchmark firmware: runs every mode for BENCH_FRAMES frames and reports
+// render time, show time and sensor edge to first shown frame over Serial.
+// Ends with PASS or FAIL against the budgets in Bench.hpp.
+//
+//   pio run -e bench_esp32_dev -t upload -t monitor
+//
+// pio test -e bench_<board> runs the same budgets as Unity tests (test/test_embedded)
+
+#include <Arduino.h>
+
+#include "Bench.hpp"
+
+#ifndef PIO_UNIT_TESTING
+
+void setup() {
+  Serial.begin(115200);
+  delay(500);
+  
+  Serial.println();
+  Serial.println("[BENCH] ========================================");
+#ifdef ESP32
+  Serial.printf("[BENCH] Board: %s @ %lu MHz\n", ESP.getChipModel(), (unsigned long)ESP.getCpuFreqMHz());
+#elif defined(ESP8266)
+  Serial.printf("[BENCH] Board: ESP8266 @ %lu MHz\n", (unsigned long)ESP.getCpuFreqMHz());
+#endif
+  Serial.printf("[BENCH] %d LEDs, %d fps target, %d frames, %d coins per mode\n",
+                NUM_LEDS, TARGET_FPS, BENCH_FRAMES, BENCH_DONATIONS);
+  Serial.println("[BENCH] ========================================");
+  
+  benchSetup();
+  
+  uint8_t failedModes = 0;
+  for (uint8_t i = 0; i < BENCH_MODE_COUNT; i++) {
+    BenchResult result;
+    benchMode(i, result);
+    if (!result.passed()) {
+      failedModes++;
+    }
+  }
+  
+  if (failedModes == 0) {
+    Serial.println("[BENCH] PASS");
+  } else {
+    Serial.printf("[BENCH] FAIL: %u of %d modes over budget\n", failedModes, BENCH_MODE_COUNT);
+  }
+  Serial.println("[BENCH] done");
+}
+
+void loop() {
+  delay(1000);
+}
+
+#endif // PIO_UNIT_TESTING
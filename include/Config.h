@@ -26,7 +26,15 @@
 // ============================================================================
 //                              LED CONFIGURATION
 // ============================================================================
-#define NUM_LEDS            6       // Number of LEDs in WS2812B strip
+// Modes address logical pixels 0..NUM_LEDS-1, strip n holds pixels
+// n * LED_STRIP_LENGTH onwards. DATA_PIN drives strip 0, DATA_PIN_2 to
+// DATA_PIN_6 the others. On the ESP32 all strips are sent at the same time
+// (RMT, or I2S with -DFASTLED_ESP32_I2S), so refresh time follows the
+// longest strip; the ESP8266 sends them one after another.
+#define LED_STRIP_COUNT     1       // Strips on separate data pins, e.g. one per cube face (1-6)
+#define LED_STRIP_LENGTH    6       // WS2812B LEDs per strip
+#define LED_STRIP_REVERSED  0       // Bit n set: strip n is wired from its far end
+#define NUM_LEDS            (LED_STRIP_COUNT * LED_STRIP_LENGTH) // Logical pixels
 #define LED_TYPE            WS2812B // FastLED type for WS2812B LEDs
 #define MAX_BRIGHTNESS      255     // Maximum LED brightness (0-255)
 #define MIN_BRIGHTNESS      0       // Minimum brightness for breathing effect
@@ -35,6 +43,54 @@
 #define BRIGHTNESS_STEP     15      // Step size for brightness change
 #define DELAY               50      // Delay between brightness changes
 #define EFFECT_DURATION     200     // Duration of the donation effect
+#if LED_STRIP_COUNT < 1 || LED_STRIP_COUNT > 6
+#error "LED_STRIP_COUNT must be between 1 and 6"
+#endif
+#ifndef NATIVE
+#if (LED_STRIP_COUNT >= 2 && !defined(DATA_PIN_2)) || (LED_STRIP_COUNT >= 3 && !defined(DATA_PIN_3)) || \
+    (LED_STRIP_COUNT >= 4 && !defined(DATA_PIN_4)) || (LED_STRIP_COUNT >= 5 && !defined(DATA_PIN_5)) || \
+    (LED_STRIP_COUNT >= 6 && !defined(DATA_PIN_6))
+#error "Define DATA_PIN_2 ... DATA_PIN_<LED_STRIP_COUNT> for the additional strips"
+#endif
+#endif
+#define MODE_TRANSITION_MS  500     // Crossfade between two modes (0 = hard cut)
+#define LED_TEMPORAL_DITHER 1       // Dither the low byte of the 16-bit brightness over 8 frames
+#define LED_POWER_BUDGET_MA 500     // LED share of the supply, frames above it are dimmed (0 = unlimited)
+#define LED_MA_PER_CHANNEL  20      // WS2812B current of one color channel at full scale
+#define LED_IDLE_MA         1       // WS2812B current per LED when dark
+
+// ============================================================================
+//                            SENSOR CONFIGURATION
+// ============================================================================
+#define SENSOR_USE_INTERRUPT    1   // Capture edges via GPIO interrupt (0 = poll in loop)
+#define SENSOR_DEBOUNCE_MS      5   // Minimum time between two accepted edges
+#define SENSOR_EDGE_BUFFER_SIZE 16  // Edges buffered between two Controller passes
+#define DONATION_MIN_INTERVAL_MS 100 // Rising edges closer than this are one coin (a coin blocks the sensor longer)
+#define DONATION_BURST_EXTEND_MS 1500 // A further coin keeps the running effect going at least this long
+#define DONATION_BURST_MAX_MS   15000 // A burst never holds one effect longer than this
+#define DONATION_BURST_STEPS    3   // Coins until a burst lifts the effect to full brightness
+
+// ============================================================================
+//                             FRAME TIMING
+// ============================================================================
+#define TARGET_FPS          60      // Render rate of the active mode (frames per second)
+#define MAX_FRAME_DT        250     // Upper bound for dt after long blocking calls (ms)
+#define CONTROLLER_EVENT_QUEUE_SIZE 16 // Mode/donation events between two I/O passes (power of two)
+
+// ============================================================================
+//                              ANIMATION MODE
+// ============================================================================
+#define ENABLE_ANIMATION_MODE 1     // Keyframe program from LittleFS, uploaded on <base topic>/cmd/animation
+#define ANIMATION_MAX_SIZE  512     // Program bytes incl. header (must fit MQTT_BUFFER_SIZE)
+#define ANIMATION_MAX_OPS   32      // Instructions per frame, bounds the render time of any program
+
+// ============================================================================
+//                              IDLE POWER MODE
+// ============================================================================
+#define ENABLE_IDLE_MODE    1       // Slow down after IDLE_TIMEOUT without a donation
+#define IDLE_TIMEOUT        300000  // No donation or remote command for 5 minutes
+#define IDLE_FPS            20      // Render rate while idle
+#define IDLE_CPU_MHZ        80      // ESP32 CPU clock while idle (0 = unchanged, WiFi needs at least 80)
 
 // ============================================================================
 //                             WIFI CONFIGURATION
@@ -51,6 +107,11 @@
 // Connection timeouts
 #define WIFI_TIMEOUT        10000   // WiFi connection timeout in milliseconds
 #define WIFI_RETRY_INTERVAL 30000   // WiFi retry interval in milliseconds
+#define RECONNECT_BACKOFF_MIN  1000 // First retry delay after a failed WiFi/MQTT attempt
+#define RECONNECT_BACKOFF_MAX 60000 // Retry delay doubles on every failure up to this limit
+#define WIFI_FAST_CONNECT   1       // Join the last access point directly (BSSID and channel cached in LittleFS)
+#define WIFI_FAST_TIMEOUT   3000    // Give the direct join this long, then fall back to a full scan
+#define WIFI_CACHE_STATIC_IP 0      // Also reuse the last DHCP lease as static IP (skips DHCP, needs a fixed lease)
 
 // ============================================================================
 //                             MQTT CONFIGURATION
@@ -66,6 +127,38 @@
 #define MQTT_KEEPALIVE      60                  // Keep-alive interval in seconds
 #define MQTT_CLEAN_SESSION  true                // Clean session flag
 #define MQTT_TIMEOUT        5000                // MQTT connection timeout in milliseconds
+#define MQTT_CONNECT_TIMEOUT 1000               // Longest TCP connect to the broker, the one wait of a single-core render loop
+#define MQTT_SOCKET_TIMEOUT 1                   // PubSubClient socket timeout in seconds (bounds connect())
+#define MQTT_BUFFER_SIZE    1024                // PubSubClient packet buffer, also caps a replay batch
+#define MQTT_TOPIC_LENGTH   64                  // Max length of a full topic incl. terminator
+#define METRICS_INTERVAL    60000               // Publish profiling metrics every 60 seconds
+#define MQTT_BINARY_TELEMETRY 0                 // Status and heartbeat as compact binary records (scripts/decode_telemetry.py)
+#define ENABLE_MQTT_COMMANDS 1                  // Accept commands on <base topic>/cmd/<name>
+#define REMOTE_COMMAND_QUEUE_SIZE 8             // Commands handed from MQTT to the render loop (power of two)
+
+// Offline event queue
+#define EVENT_QUEUE_SIZE    32                  // Donation/mode events kept while the broker is unreachable
+#define EVENT_BATCH_SIZE    8                   // Queued events per replay publish
+#define EVENT_QUEUE_PERSIST 0                   // Persist queued events to LittleFS across reboots
+#define MODE_NAME_LENGTH    20                  // Max stored length of a mode name (incl. terminator)
+
+// ============================================================================
+//                              OTA UPDATES
+// ============================================================================
+#define ENABLE_OTA          1                   // Firmware update from an HTTP URL sent to <base topic>/cmd/update
+#define OTA_URL_LENGTH      128                 // Max length of the image URL incl. terminator
+#define OTA_CHUNK_SIZE      1024                // Bytes moved from WiFi to flash per I/O pass
+#define OTA_TIMEOUT         15000               // Abort when the server sends nothing for this long
+#define OTA_CONNECT_TIMEOUT 1000                // Longest TCP connect, the one wait of a single-core render loop
+#define OTA_RESTART_DELAY   2000                // Time for the last MQTT status before the reboot
+
+// ============================================================================
+//                           DONATION STATISTICS
+// ============================================================================
+#define ENABLE_DONATION_STATS 1                 // Count donations on the device, retained on <base topic>/stats
+#define DONATION_STATS_MODES  8                 // Per-mode counters, higher mode indices share the last one
+#define DONATION_STATS_PERSIST_INTERVAL 300000  // Write changed counters to LittleFS at most every 5 minutes
+#define DONATION_STATS_PUBLISH_INTERVAL 10000   // Minimum time between two summaries
 
 // ============================================================================
 //                            DFPLAYER CONFIGURATION
@@ -74,6 +167,13 @@
 #define DFPLAYER_TIMEOUT    500    // Command timeout in milliseconds
 #define DFPLAYER_RETRY      3      // Number of retry attempts
 #define DFPLAYER_BAUD_RATE  9600   // Serial communication baud rate
+#define DFPLAYER_QUEUE_SIZE 8      // Pending commands, sent from SpeakerService::loop()
+#define DFPLAYER_COMMAND_GAP 40    // Minimum time between two commands (covers the ACK round trip)
+#define DFPLAYER_RESET_TIME 1000   // Time the DFPlayer needs after a reset command
+#define DFPLAYER_STARTUP_DELAY 3000 // Power-up time of the DFPlayer before the first command
+#define DFPLAYER_READY_TIMEOUT 5000 // Max wait for the card-online message, then continue anyway
+#define SOUND_ENVELOPE_POINTS 8    // Loudness samples per track in SoundTable.h
+#define SOUND_EFFECT_MAX_MS 10000  // Effect of a track missing from SoundTable.h, until its playback-finished message
 
 // Sound file configuration
 #define DONATION_SOUND_COUNT  16   // Number of donation sound files (001.mp3 - 005.mp3)
@@ -95,4 +195,20 @@
 // Other optional features
 #define ENABLE_SERIAL_DEBUG 0                   // Enable Serial debug output (0 = disabled for production)
 #define ENABLE_HEARTBEAT    ENABLE_MQTT         // Enable MQTT heartbeat messages
-#define ENABLE_AUTO_RECONNECT ENABLE_WIFI       // Enable automatic WiFi/MQTT reconnection
\ No newline at end of file
+#define ENABLE_AUTO_RECONNECT ENABLE_WIFI       // Enable automatic WiFi/MQTT reconnection
+#define ENABLE_PROFILING    1                   // Hot-path timers, published on the metrics topic
+#define ENABLE_SERIAL_CONSOLE ENABLE_SERIAL_DEBUG // Debug commands on the serial port ("mem", "help")
+
+// Dual-core runtime (ESP32 only, enabled per environment in platformio.ini)
+#ifndef ENABLE_DUAL_CORE
+#define ENABLE_DUAL_CORE    0                   // Run MQTT/DFPlayer I/O as a FreeRTOS task on the other core
+#endif
+
+#if ENABLE_DUAL_CORE
+#if !defined(ESP32)
+#error "ENABLE_DUAL_CORE requires an ESP32 target"
+#endif
+#define IO_TASK_CORE        0                   // Core of the I/O task (the WiFi stack runs there too)
+#define IO_TASK_STACK_SIZE  8192                // Stack of the I/O task in bytes
+#define IO_TASK_PRIORITY    1                   // Same priority as the Arduino loop task
+#endif
\ No newline at end of file
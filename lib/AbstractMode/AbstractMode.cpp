@@ -3,6 +3,75 @@
 void AbstractMode::startDonationEffect() {
     effectActive = true;
     effectStartTime = millis();
+    effectLength = effectDuration;
+    effectHold = 0;
+    donationAmount = 1;
+    soundTrack = 0;
+    soundKnown = false;
+    soundEnded = false;
+}
+
+void AbstractMode::startDonationSound() {
+    soundTrack = speakerService->playDonationSound();
+    if (soundTrack == 0) {
+        // No DFPlayer: the mode's own duration
+        return;
+    }
+    
+    soundKnown = SpeakerService::getSound(soundTrack, sound);
+    // Unlisted tracks run until the DFPlayer reports the end, the limit
+    // covers a lost message
+    effectLength = soundKnown ? sound.durationMs : SOUND_EFFECT_MAX_MS;
+}
+
+void AbstractMode::soundFinished(uint16_t track) {
+    if (effectActive && track == soundTrack) {
+        soundEnded = true;
+    }
+}
+
+void AbstractMode::addDonation() {
+    if (!effectActive) {
+        return;
+    }
+    if (donationAmount < 255) {
+        donationAmount++;
+    }
+    
+    // The sound keeps playing, only the light effect is held for the new coin
+    unsigned long elapsed = millis() - effectStartTime;
+    effectHold = min(elapsed + DONATION_BURST_EXTEND_MS, (unsigned long)DONATION_BURST_MAX_MS);
+}
+
+bool AbstractMode::donationEffectDone(unsigned long now) const {
+    if (!effectActive) {
+        return false;
+    }
+    unsigned long elapsed = now - effectStartTime;
+    return (soundEnded || elapsed >= effectLength) && elapsed >= effectHold;
+}
+
+uint8_t AbstractMode::effectIntensity(unsigned long now) const {
+    if (!effectActive || !soundKnown) {
+        return 255;
+    }
+    
+    // Linear between the envelope points, the last one holds
+    unsigned long elapsed = min(now - effectStartTime, (unsigned long)sound.durationMs);
+    uint32_t position = (uint32_t)elapsed * (SOUND_ENVELOPE_POINTS - 1) * 256 / sound.durationMs;
+    uint8_t index = position >> 8;
+    int16_t level;
+    if (index >= SOUND_ENVELOPE_POINTS - 1) {
+        level = sound.levels[SOUND_ENVELOPE_POINTS - 1];
+    } else {
+        int16_t from = sound.levels[index];
+        int16_t to = sound.levels[index + 1];
+        level = from + ((to - from) * (int16_t)(position & 0xFF)) / 256;
+    }
+    
+    // Every further coin closes part of the gap to full brightness
+    uint8_t extra = min(donationAmount - 1, DONATION_BURST_STEPS);
+    return level + ((255 - level) * extra) / DONATION_BURST_STEPS;
 }
 
 void AbstractMode::endDonationEffect() {
@@ -18,6 +87,9 @@ bool AbstractMode::isActive() {
 
 void AbstractMode::activate() {
     active = true;
+    stepAccumulator = 0;
+    // The previous mode's last frame fades into the first frames of this one
+    lightService->startTransition(MODE_TRANSITION_MS);
     setup();
 }
 
@@ -25,13 +97,24 @@ void AbstractMode::deactivate() {
     active = false;
 }
 
+uint16_t AbstractMode::consumeSteps(unsigned long dt, unsigned long interval) {
+    if (interval == 0) {
+        return 1;
+    }
+    
+    stepAccumulator += dt;
+    uint16_t steps = stepAccumulator / interval;
+    stepAccumulator %= interval;
+    return steps;
+}
+
 void AbstractMode::printModeInfo() const {
     Serial.println("========================================");
     Serial.println("           MODE INFORMATION");
     Serial.println("========================================");
-    Serial.print("Name:        "); Serial.println(name);
-    Serial.print("Description: "); Serial.println(description);
-    Serial.print("Author:      "); Serial.println(author);
-    Serial.print("Version:     "); Serial.println(version);
+    Serial.print("Name:        "); Serial.println(info.name);
+    Serial.print("Description: "); Serial.println(getDescription());
+    Serial.print("Author:      "); Serial.println(getAuthor());
+    Serial.print("Version:     "); Serial.println(getVersion());
     Serial.println("========================================");
 }
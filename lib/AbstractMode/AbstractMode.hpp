@@ -8,45 +8,77 @@
 
 #include "Config.h"
 
+// Mode metadata in static storage. The name stays in RAM because it is
+// published with every MQTT event, the rest is only printed and lives in
+// flash (declare those strings PROGMEM, which matters on the ESP8266).
+struct ModeInfo {
+    const char* name;
+    const char* description; // PROGMEM
+    const char* author;      // PROGMEM
+    const char* version;     // PROGMEM
+};
+
 class AbstractMode {
     private:
         bool active = false;
-        String name;
-        String description;
-        String author;
-        String version;
+        const ModeInfo& info;
         
     protected:
         unsigned long effectStartTime = 0;
         bool effectActive = false;
         unsigned long effectDuration = 3000; // Default 3 seconds, can be overridden
+        unsigned long effectLength = 0;      // Length of the running effect, follows the donation sound
+        unsigned long effectHold = 0;        // Further coins keep the effect running at least this long
+        uint8_t donationAmount = 0;          // Coins in the running effect
+        unsigned long stepAccumulator = 0;   // Frame time not yet consumed by animation steps
+
+        // Donation sound of the running effect
+        uint16_t soundTrack = 0;   // 0 = none played
+        bool soundKnown = false;   // sound holds its SoundTable.h entry
+        bool soundEnded = false;   // DFPlayer reported the track as finished
+        SoundEnvelope sound;
         
         LightService* lightService;
         SpeakerService* speakerService;
+
+        // Turns frame time into fixed animation steps, keeps speed independent of frame rate
+        uint16_t consumeSteps(unsigned long dt, unsigned long interval);
+
+        // Plays the donation sound and fits the effect to it, call after startDonationEffect()
+        void startDonationSound();
+        // Effect ran its length or its sound finished
+        bool donationEffectDone(unsigned long now) const;
+        // Loudness of the donation sound at now (255 without a SoundTable.h entry),
+        // raised towards full brightness by a burst of coins
+        uint8_t effectIntensity(unsigned long now) const;
     
     public:
-        AbstractMode(LightService* lightService, SpeakerService* speakerService, 
-                    const String& name, const String& description, const String& author, const String& version)
-            : lightService(lightService), speakerService(speakerService), 
-              name(name), description(description), author(author), version(version) {}
+        // info must have static storage duration
+        AbstractMode(LightService* lightService, SpeakerService* speakerService, const ModeInfo& info)
+            : info(info), lightService(lightService), speakerService(speakerService) {}
         AbstractMode(LightService* lightService, SpeakerService* speakerService, unsigned long duration,
-                    const String& name, const String& description, const String& author, const String& version)
-            : lightService(lightService), speakerService(speakerService), effectDuration(duration),
-              name(name), description(description), author(author), version(version) {}
+                    const ModeInfo& info)
+            : info(info), effectDuration(duration), lightService(lightService), speakerService(speakerService) {}
         virtual ~AbstractMode() {}
 
         void startDonationEffect();
         void endDonationEffect();
+        // Coin during the running effect, called by the Controller instead of donationTriggered()
+        void addDonation();
         
         bool isDonationEffectActive() const { return effectActive; }
         unsigned long getDonationStartTime() const { return effectStartTime; }
-        unsigned long getEffectDuration() const { return effectDuration; }
+        uint8_t getDonationAmount() const { return donationAmount; }
+        unsigned long getEffectDuration() const { return effectActive ? effectLength : effectDuration; }
+
+        // Playback-finished message from SpeakerService, passed on by the Controller
+        void soundFinished(uint16_t track);
         
         // Metadata getters
-        const String& getName() const { return name; }
-        const String& getDescription() const { return description; }
-        const String& getAuthor() const { return author; }
-        const String& getVersion() const { return version; }
+        const char* getName() const { return info.name; }
+        const __FlashStringHelper* getDescription() const { return FPSTR(info.description); }
+        const __FlashStringHelper* getAuthor() const { return FPSTR(info.author); }
+        const __FlashStringHelper* getVersion() const { return FPSTR(info.version); }
         void printModeInfo() const;
 
         bool isActive();
@@ -54,7 +86,7 @@ class AbstractMode {
         void deactivate();
 
         virtual void donationTriggered() = 0;
-        virtual void loop() = 0;
+        virtual void renderFrame(unsigned long now, unsigned long dt) = 0;
         virtual void setup() = 0;
 };
 
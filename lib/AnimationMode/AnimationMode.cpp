@@ -0,0 +1,365 @@
+#include "AnimationMode.hpp"
+#include "Config.h"
+#include <Arduino.h>
+
+#if !defined(NATIVE)
+#include <LittleFS.h>
+
+static const char* ANIMATION_FILE = "/anim.bin";
+static const char* ANIMATION_TEMP_FILE = "/anim.tmp";
+
+static bool mountFileSystem() {
+#ifdef ESP32
+    return LittleFS.begin(true);
+#else
+    return LittleFS.begin();
+#endif
+}
+#endif
+
+static const char animationModeDescription[] PROGMEM = "Keyframe animation loaded from LittleFS or MQTT";
+static const char animationModeAuthor[] PROGMEM = "Friedjof";
+static const char animationModeVersion[] PROGMEM = "v1.0.0";
+static const ModeInfo animationModeInfo = {"Animation", animationModeDescription, animationModeAuthor, animationModeVersion};
+
+static const uint16_t ANIMATION_MAGIC = 0x4E41; // "AN"
+static const uint8_t ANIMATION_VERSION = 1;
+static const size_t HEADER_SIZE = 10;
+
+// Operand bytes per opcode, indexed by AnimationOp
+static const uint8_t OPERAND_SIZE[] = {0, 4, 1, 3, 5, 2, 1, 2, 3};
+static const uint8_t OP_COUNT = sizeof(OPERAND_SIZE);
+
+// Built-in program until one is uploaded, source in lib/AnimationMode/README.md
+static const uint8_t DEFAULT_PROGRAM[] PROGMEM = {
+    0x41, 0x4E, 0x01, 0x00, 0x1B, 0x00, 0xC4, 0x09, 0x38, 0x00, 0x06, 0xC8, 0x03, 0xFF, 0x00, 0x50,
+    0x04, 0xD0, 0x07, 0x00, 0x50, 0xFF, 0x04, 0xD0, 0x07, 0x00, 0xFF, 0x78, 0x04, 0xD0, 0x07, 0xFF,
+    0x00, 0x50, 0x07, 0x06, 0x00, 0x06, 0xFF, 0x03, 0xFF, 0xFF, 0xFF, 0x05, 0x96, 0x00, 0x03, 0x00,
+    0x00, 0x00, 0x05, 0x96, 0x00, 0x08, 0x04, 0x1D, 0x00, 0x04, 0x14, 0x05, 0xFF, 0xB4, 0x3C, 0x05,
+    0x60, 0xEA,
+};
+
+static uint16_t read16(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+static uint8_t lerp8(uint8_t from, uint8_t to, uint8_t amount) {
+    return from + (((int16_t)to - from) * amount) / 255;
+}
+
+AnimationMode::AnimationMode(LightService* lightService, SpeakerService* speakerService)
+    : AbstractMode(lightService, speakerService, animationModeInfo) {
+    memcpy_P(program, DEFAULT_PROGRAM, sizeof(DEFAULT_PROGRAM));
+    use(program, sizeof(DEFAULT_PROGRAM));
+}
+
+bool AnimationMode::validate(const uint8_t* data, size_t length) {
+    if (length < HEADER_SIZE || length > ANIMATION_MAX_SIZE ||
+        read16(data) != ANIMATION_MAGIC || data[2] != ANIMATION_VERSION) {
+        return false;
+    }
+
+    uint16_t codeLength = read16(data + 8);
+    uint16_t donationEntry = read16(data + 4);
+    if (codeLength == 0 || HEADER_SIZE + codeLength != length) {
+        return false;
+    }
+
+    // Walk the code once: known opcodes, operands inside the program, and
+    // every jump lands on the start of an instruction
+    const uint8_t* code = data + HEADER_SIZE;
+    uint8_t starts[ANIMATION_MAX_SIZE / 8] = {0};
+    uint16_t pc = 0;
+    while (pc < codeLength) {
+        if (code[pc] >= OP_COUNT || pc + 1 + OPERAND_SIZE[code[pc]] > codeLength) {
+            return false;
+        }
+        starts[pc / 8] |= 1 << (pc % 8);
+        pc += 1 + OPERAND_SIZE[code[pc]];
+    }
+
+    for (pc = 0; pc < codeLength; pc += 1 + OPERAND_SIZE[code[pc]]) {
+        uint16_t target;
+        if (code[pc] == ANIM_JUMP) {
+            target = read16(code + pc + 1);
+        } else if (code[pc] == ANIM_REPEAT) {
+            target = read16(code + pc + 2);
+        } else {
+            continue;
+        }
+        if (target >= codeLength || !(starts[target / 8] & (1 << (target % 8)))) {
+            return false;
+        }
+    }
+
+    return donationEntry == NO_TRACK ||
+           (donationEntry < codeLength && (starts[donationEntry / 8] & (1 << (donationEntry % 8))));
+}
+
+bool AnimationMode::use(const uint8_t* data, size_t length) {
+    if (!validate(data, length)) {
+        return false;
+    }
+
+    if (data != program) {
+        memcpy(program, data, length);
+    }
+    codeLength = read16(program + 8);
+    donationEntry = read16(program + 4);
+    effectDuration = read16(program + 6);
+    return true;
+}
+
+const uint8_t* AnimationMode::code() const {
+    return program + HEADER_SIZE;
+}
+
+bool AnimationMode::reload() {
+    if (!load()) {
+        return false;
+    }
+    if (isActive()) {
+        startIdleTrack();
+    }
+    return true;
+}
+
+bool AnimationMode::load() {
+#if !defined(NATIVE)
+    if (!mountFileSystem()) {
+        Serial.println("[AnimationMode] LittleFS unavailable - using the built-in program");
+        return false;
+    }
+
+    // Same swap as DonationStats, a reset during save() leaves the temp file complete
+    const char* path = LittleFS.exists(ANIMATION_FILE) ? ANIMATION_FILE : ANIMATION_TEMP_FILE;
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    // Read into a scratch buffer, the running program stays intact if the file is bad
+    static uint8_t buffer[ANIMATION_MAX_SIZE];
+    size_t length = file.read(buffer, sizeof(buffer));
+    file.close();
+
+    if (!use(buffer, length)) {
+        Serial.println("[AnimationMode] Ignoring invalid animation file");
+        return false;
+    }
+
+    Serial.print("[AnimationMode] Loaded ");
+    Serial.print(length);
+    Serial.println(" byte program");
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool AnimationMode::save(const uint8_t* data, size_t length) {
+    if (!validate(data, length)) {
+        Serial.println("[AnimationMode] Rejected invalid program");
+        return false;
+    }
+
+#if !defined(NATIVE)
+    if (!mountFileSystem()) {
+        Serial.println("[AnimationMode] LittleFS unavailable - program not stored");
+        return false;
+    }
+
+    // Retained uploads arrive again on every reconnect, skip the flash write
+    File current = LittleFS.open(ANIMATION_FILE, "r");
+    if (current) {
+        bool same = current.size() == length;
+        for (size_t i = 0; same && i < length; i++) {
+            same = current.read() == data[i];
+        }
+        current.close();
+        if (same) {
+            return false;
+        }
+    }
+
+    File file = LittleFS.open(ANIMATION_TEMP_FILE, "w");
+    if (!file) {
+        Serial.println("[AnimationMode] Unable to write animation file");
+        return false;
+    }
+    size_t written = file.write(data, length);
+    file.close();
+
+    if (written != length) {
+        Serial.println("[AnimationMode] Animation file incomplete, keeping the previous one");
+        return false;
+    }
+    LittleFS.remove(ANIMATION_FILE);
+    LittleFS.rename(ANIMATION_TEMP_FILE, ANIMATION_FILE);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AnimationMode::setup() {
+    Serial.println("[INFO] AnimationMode setup - Running keyframe program");
+    lightService->setup();
+    lightService->setBrightness(255);
+
+    // First activation: replace the built-in program with the stored one
+    if (!loaded) {
+        loaded = true;
+        load();
+    }
+
+    startIdleTrack();
+}
+
+void AnimationMode::donationTriggered() {
+    Serial.println("[INFO] AnimationMode donation triggered");
+    startDonationEffect();
+
+    // Programs without a donation track keep running their idle track
+    if (donationEntry != NO_TRACK) {
+        startTrack(donationEntry, codeLength);
+    }
+
+    startDonationSound();
+}
+
+void AnimationMode::startIdleTrack() {
+    color = CRGB::Black;
+    startTrack(0, donationEntry == NO_TRACK ? codeLength : donationEntry);
+}
+
+void AnimationMode::startTrack(uint16_t entry, uint16_t end) {
+    trackEntry = entry;
+    trackEnd = end;
+    pc = entry;
+    selectFirst = 0;
+    selectCount = NUM_LEDS;
+    selectFace = 0xFF;
+    repeatLeft = 0;
+    holding = false;
+    fading = false;
+    holdStart = millis();
+    holdDuration = 0;
+}
+
+void AnimationMode::renderFrame(unsigned long now, unsigned long dt) {
+    if (donationEffectDone(now)) {
+        endDonationEffect();
+        Serial.println("[INFO] AnimationMode donation effect ended - mode will deactivate");
+        return;
+    }
+
+    if (holding) {
+        unsigned long elapsed = now - holdStart;
+        if (fading) {
+            uint8_t amount = elapsed >= holdDuration ? 255 : (elapsed * 255) / holdDuration;
+            fillSelection(CRGB(lerp8(fadeFrom.r, color.r, amount),
+                               lerp8(fadeFrom.g, color.g, amount),
+                               lerp8(fadeFrom.b, color.b, amount)));
+        }
+        if (elapsed < holdDuration) {
+            return;
+        }
+        holding = false;
+        fading = false;
+    }
+
+    step(now);
+}
+
+void AnimationMode::step(unsigned long now) {
+    // The next keyframe starts where the last one ended, so frame jitter does
+    // not add up; after a long stall the program continues from now
+    unsigned long start = holdStart + holdDuration;
+    if (now - start > MAX_FRAME_DT) {
+        start = now;
+    }
+
+    // Bounded per frame: at most ANIMATION_MAX_OPS instructions, each touching
+    // at most NUM_LEDS pixels. WAIT, FADE and the end of the track yield early.
+    for (uint8_t ops = 0; ops < ANIMATION_MAX_OPS; ops++) {
+        if (pc >= trackEnd) {
+            startTrack(trackEntry, trackEnd);
+            holdStart = start;
+            return;
+        }
+
+        const uint8_t* op = code() + pc;
+        switch (op[0]) {
+            case ANIM_END:
+                startTrack(trackEntry, trackEnd);
+                holdStart = start;
+                return;
+            case ANIM_SELECT:
+                selectFirst = read16(op + 1);
+                selectCount = read16(op + 3);
+                selectFace = 0xFF;
+                break;
+            case ANIM_FACE:
+                selectFace = op[1];
+                break;
+            case ANIM_FILL:
+                color = CRGB(op[1], op[2], op[3]);
+                fillSelection(color);
+                break;
+            case ANIM_FADE:
+                fadeFrom = color;
+                color = CRGB(op[3], op[4], op[5]);
+                holdStart = start;
+                holdDuration = read16(op + 1);
+                holding = true;
+                fading = true;
+                pc += 6;
+                return;
+            case ANIM_WAIT:
+                holdStart = start;
+                holdDuration = read16(op + 1);
+                holding = true;
+                pc += 3;
+                return;
+            case ANIM_BRIGHT:
+                lightService->setBrightness(op[1]);
+                break;
+            case ANIM_JUMP:
+                pc = read16(op + 1);
+                continue;
+            case ANIM_REPEAT:
+                if (repeatLeft == 0) {
+                    repeatLeft = max(op[1], (uint8_t)1);
+                }
+                if (--repeatLeft > 0) {
+                    pc = read16(op + 2);
+                    continue;
+                }
+                break;
+        }
+        pc += 1 + OPERAND_SIZE[op[0]];
+    }
+}
+
+void AnimationMode::fillSelection(const CRGB& target) {
+    if (selectFace != 0xFF) {
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            if (lightService->getPosition(i).face == selectFace) {
+                lightService->setLedColor(i, target);
+            }
+        }
+        return;
+    }
+
+    if (selectFirst == 0 && selectCount >= NUM_LEDS) {
+        lightService->setColor(target);
+        return;
+    }
+
+    // Programs are shared between boxes, pixels past this strip are skipped
+    uint16_t last = min((uint32_t)selectFirst + selectCount, (uint32_t)NUM_LEDS);
+    for (uint16_t i = selectFirst; i < last; i++) {
+        lightService->setLedColor(i, target);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef ANIMATION_MODE_HPP
+#define ANIMATION_MODE_HPP
+
+#include "AbstractMode.hpp"
+
+// Program layout, see README.md and scripts/build_animation.py
+//   u16 magic, u8 version, u8 flags, u16 donation entry, u16 effect ms, u16 code length, code...
+// Offsets are relative to the first code byte, all values little endian.
+enum AnimationOp : uint8_t {
+    ANIM_END    = 0x00, // End of track: yield, then restart the track
+    ANIM_SELECT = 0x01, // u16 first, u16 count: pixels for FILL/FADE (default: all)
+    ANIM_FACE   = 0x02, // u8 face: select all pixels of one cube face
+    ANIM_FILL   = 0x03, // u8 r, g, b: set the selection
+    ANIM_FADE   = 0x04, // u16 ms, u8 r, g, b: blend the selection from the last color to r, g, b
+    ANIM_WAIT   = 0x05, // u16 ms: hold the frame
+    ANIM_BRIGHT = 0x06, // u8 brightness
+    ANIM_JUMP   = 0x07, // u16 offset
+    ANIM_REPEAT = 0x08  // u8 count, u16 offset: jump back until the body ran count times
+};
+
+class AnimationMode : public AbstractMode {
+    public:
+        static const uint16_t NO_TRACK = 0xFFFF; // Donation entry of programs without a donation track
+
+    private:
+        uint8_t program[ANIMATION_MAX_SIZE]; // Validated program, header included
+        uint16_t codeLength = 0;
+        uint16_t donationEntry = NO_TRACK;
+        bool loaded = false;
+
+        // Interpreter state
+        uint16_t trackEntry = 0;
+        uint16_t trackEnd = 0;     // Idle track: code before the donation entry, donation track: the rest
+        uint16_t pc = 0;
+        uint16_t selectFirst = 0;
+        uint16_t selectCount = NUM_LEDS;
+        uint8_t selectFace = 0xFF; // 0xFF = selection is the range above
+        uint8_t repeatLeft = 0;
+        CRGB color;                // Last FILL/FADE color, the start of the next FADE
+        CRGB fadeFrom;
+        unsigned long holdStart = 0;
+        uint16_t holdDuration = 0;
+        bool holding = false;      // Inside a WAIT or FADE
+        bool fading = false;
+
+        void startTrack(uint16_t entry, uint16_t end);
+        void startIdleTrack();
+        void step(unsigned long now);
+        void fillSelection(const CRGB& target);
+        const uint8_t* code() const;
+        bool use(const uint8_t* data, size_t length);
+        bool load();
+
+    public:
+        AnimationMode(LightService* lightService, SpeakerService* speakerService);
+
+        void donationTriggered() override;
+        void renderFrame(unsigned long now, unsigned long dt) override;
+        void setup() override;
+
+        // Reads /anim.bin again, e.g. after save(); keeps the current program if it is invalid
+        bool reload();
+
+        // Checks a program and stores it as /anim.bin, false if invalid or unchanged
+        static bool save(const uint8_t* data, size_t length);
+        static bool validate(const uint8_t* data, size_t length);
+};
+
+#endif // ANIMATION_MODE_HPP
@@ -0,0 +1,55 @@
+#include "BinaryWriter.hpp"
+
+BinaryWriter::BinaryWriter(uint8_t* buffer, size_t capacity)
+    : buffer(buffer), capacity(capacity) {
+}
+
+void BinaryWriter::reset() {
+    length = 0;
+    overflow = false;
+}
+
+bool BinaryWriter::reserve(size_t bytes) {
+    if (length + bytes > capacity) {
+        overflow = true;
+        return false;
+    }
+    return true;
+}
+
+BinaryWriter& BinaryWriter::u8(uint8_t value) {
+    if (reserve(1)) {
+        buffer[length++] = value;
+    }
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::u16(uint16_t value) {
+    if (reserve(2)) {
+        buffer[length++] = value & 0xFF;
+        buffer[length++] = value >> 8;
+    }
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::u32(uint32_t value) {
+    if (reserve(4)) {
+        for (uint8_t i = 0; i < 4; i++) {
+            buffer[length++] = (value >> (8 * i)) & 0xFF;
+        }
+    }
+    return *this;
+}
+
+BinaryWriter& BinaryWriter::str(const char* value) {
+    size_t textLength = value ? strlen(value) : 0;
+    if (textLength > 255) {
+        textLength = 255;
+    }
+    if (reserve(1 + textLength)) {
+        buffer[length++] = textLength;
+        memcpy(buffer + length, value, textLength);
+        length += textLength;
+    }
+    return *this;
+}
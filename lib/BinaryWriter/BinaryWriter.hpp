@@ -0,0 +1,36 @@
+#ifndef BINARY_WRITER_HPP
+#define BINARY_WRITER_HPP
+
+#include <Arduino.h>
+
+/**
+ * Binary Writer - packs little-endian fields into a caller-provided fixed buffer
+ * Counterpart to JsonWriter for compact payloads; fields that do not fit
+ * are dropped (and flagged) instead of growing
+ */
+class BinaryWriter {
+    private:
+        uint8_t* buffer;
+        size_t capacity;
+        size_t length = 0;
+        bool overflow = false;
+
+        bool reserve(size_t bytes);
+
+    public:
+        BinaryWriter(uint8_t* buffer, size_t capacity);
+
+        void reset();
+
+        BinaryWriter& u8(uint8_t value);
+        BinaryWriter& u16(uint16_t value);
+        BinaryWriter& u32(uint32_t value);
+        // Length byte followed by the characters, cut at 255
+        BinaryWriter& str(const char* value);
+
+        const uint8_t* data() const { return buffer; }
+        size_t size() const { return length; }
+        bool overflowed() const { return overflow; }
+};
+
+#endif // BINARY_WRITER_HPP
@@ -2,12 +2,13 @@
 #include "Config.h"
 #include <Arduino.h>
 
+static const char blinkModeDescription[] PROGMEM = "Random blinking pattern with white LEDs";
+static const char blinkModeAuthor[] PROGMEM = "Friedjof";
+static const char blinkModeVersion[] PROGMEM = "v1.0.0";
+static const ModeInfo blinkModeInfo = {"Random Blink", blinkModeDescription, blinkModeAuthor, blinkModeVersion};
+
 BlinkMode::BlinkMode(LightService* lightService, SpeakerService* speakerService) 
-    : AbstractMode(lightService, speakerService,
-                  "Random Blink",
-                  "Random blinking pattern with white LEDs",
-                  "Friedjof",
-                  "v1.0.0") {
+    : AbstractMode(lightService, speakerService, blinkModeInfo) {
 }
 
 void BlinkMode::setup() {
@@ -20,7 +21,6 @@ void BlinkMode::setup() {
     effectDuration = 4000; // 4 seconds
     
     currentInterval = normalInterval;
-    lastUpdate = millis();
     
     // Initialize some LEDs as on for visibility
     for (int i = 0; i < NUM_LEDS; i++) {
@@ -42,23 +42,29 @@ void BlinkMode::donationTriggered() {
     // Speed up blinking
     currentInterval = fastInterval;
     
-    // Play sound
-    speakerService->playDonationSound();
+    // First fast blink right away, the coin shows in the next frame
+    stepAccumulator = 0;
+    updateRandomBlinks();
+    
+    // Play sound, the effect lasts as long as the clip
+    startDonationSound();
 }
 
-void BlinkMode::loop() {
-    unsigned long currentTime = millis();
-    
+void BlinkMode::renderFrame(unsigned long now, unsigned long dt) {
     // Check if donation effect should end
-    if (effectActive && currentTime - effectStartTime >= effectDuration) {
+    if (donationEffectDone(now)) {
         endDonationEffect();
         currentInterval = normalInterval; // Reset to normal speed
         Serial.println("[INFO] BlinkMode donation effect ended - mode will deactivate");
     }
+
+    // Effect brightness follows the loudness of the clip
+    if (effectActive) {
+        lightService->setBrightness(effectIntensity(now));
+    }
     
-    // Blink timing
-    if (currentTime - lastUpdate >= currentInterval) {
-        lastUpdate = currentTime;
+    // Blink timing - one random update per due step is enough, skipped ones are not visible
+    if (consumeSteps(dt, currentInterval) > 0) {
         updateRandomBlinks();
     }
 }
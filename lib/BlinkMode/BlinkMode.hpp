@@ -5,7 +5,6 @@
 
 class BlinkMode : public AbstractMode {
     private:
-        unsigned long lastUpdate = 0;
         unsigned long normalInterval = 300; // Normal blink interval
         unsigned long fastInterval = 100;   // Fast blink interval during donation
         unsigned long currentInterval = 300;
@@ -16,7 +15,7 @@ class BlinkMode : public AbstractMode {
         BlinkMode(LightService* lightService, SpeakerService* speakerService);
         
         void donationTriggered() override;
-        void loop() override;
+        void renderFrame(unsigned long now, unsigned long dt) override;
         void setup() override;
         
     private:
@@ -2,30 +2,40 @@
 #include "Config.h"
 #include <Arduino.h>
 
+static const char centerModeDescription[] PROGMEM = "Light expanding from center outwards";
+static const char centerModeAuthor[] PROGMEM = "Friedjof";
+static const char centerModeVersion[] PROGMEM = "v1.0.0";
+static const ModeInfo centerModeInfo = {"Center Expansion", centerModeDescription, centerModeAuthor, centerModeVersion};
+
 CenterMode::CenterMode(LightService* lightService, SpeakerService* speakerService) 
-    : AbstractMode(lightService, speakerService, 3000,
-                  "Center Expansion",
-                  "Light expanding from center outwards",
-                  "Friedjof",
-                  "v1.0.0") { // 3 second donation effect
-    maxRadius = NUM_LEDS / 2; // Maximum expansion radius
+    : AbstractMode(lightService, speakerService, 3000, centerModeInfo) { // 3 second donation effect
+    maxRadius = max(NUM_LEDS / 2, 1); // Rings between the center and the farthest pixel
+    buildFadeTable();
+}
+
+void CenterMode::buildFadeTable() {
+    // Brightness falls from 255 at the center to 100 at the current radius
+    fadeStep[0] = 0;
+    for (int radius = 1; radius <= maxRadius; radius++) {
+        fadeStep[radius] = ((255 - 100) << 8) / radius;
+    }
 }
 
 void CenterMode::setup() {
     Serial.println("[CenterMode] Initializing center expansion mode");
     lightService->clear();
+    lightService->setBrightness(255); // The previous effect may have dimmed it
     currentRadius = 0;
     expanding = true;
     currentInterval = normalInterval;
-    lastUpdate = millis();
 }
 
 void CenterMode::donationTriggered() {
     Serial.println("[CenterMode] Donation detected - starting fast expansion effect");
     startDonationEffect();
     
-    // Play donation sound
-    speakerService->playDonationSound();
+    // Play donation sound, the effect lasts as long as the clip
+    startDonationSound();
     
     // Speed up expansion during donation
     currentInterval = fastInterval;
@@ -33,22 +43,27 @@ void CenterMode::donationTriggered() {
     // Reset expansion from center
     currentRadius = 0;
     expanding = true;
+    stepAccumulator = 0;
+    updateExpansion();
 }
 
-void CenterMode::loop() {
-    unsigned long now = millis();
-    
+void CenterMode::renderFrame(unsigned long now, unsigned long dt) {
     // Check if donation effect should end
-    if (isDonationEffectActive() && now - getDonationStartTime() >= getEffectDuration()) {
+    if (donationEffectDone(now)) {
         endDonationEffect();
         currentInterval = normalInterval; // Return to normal speed
         return;
     }
+
+    // Effect brightness follows the loudness of the clip
+    if (effectActive) {
+        lightService->setBrightness(effectIntensity(now));
+    }
     
     // Update expansion animation
-    if (now - lastUpdate >= currentInterval) {
+    uint16_t steps = consumeSteps(dt, currentInterval);
+    while (steps--) {
         updateExpansion();
-        lastUpdate = now;
     }
 }
 
@@ -72,54 +87,24 @@ void CenterMode::updateExpansion() {
     }
     
     setRadiusLEDs(currentRadius);
-    lightService->show();
 }
 
 void CenterMode::setRadiusLEDs(int radius) {
-    if (radius <= 0) {
-        // Only center LED(s)
-        int center = NUM_LEDS / 2;
-        lightService->setLedColor(center, CRGB(255, 255, 255));
-        if (NUM_LEDS % 2 == 0) {
-            // Even number of LEDs, light both center LEDs
-            lightService->setLedColor(center - 1, CRGB(255, 255, 255));
-        }
-        return;
+    if (radius > maxRadius) {
+        radius = maxRadius;
     }
     
-    int center = NUM_LEDS / 2;
-    
-    // Light LEDs in the current radius from center
-    for (int i = 0; i < radius && i < maxRadius; i++) {
-        // Calculate brightness - brighter at center, dimmer at edges
-        int brightness = map(i, 0, radius, 255, 100);
-        brightness = constrain(brightness, 50, 255);
-        
-        // Light LEDs on both sides of center
-        int leftPos = center - i - 1;
-        int rightPos = center + i;
-        
-        if (NUM_LEDS % 2 == 0) {
-            // Even number of LEDs
-            leftPos = center - i - 1;
-            rightPos = center + i;
-        } else {
-            // Odd number of LEDs, center is at NUM_LEDS/2
-            if (i == 0) {
-                // Light center LED
-                lightService->setLedColor(center, CRGB(brightness, brightness, brightness));
-                continue;
-            }
-            leftPos = center - i;
-            rightPos = center + i;
+    // Pixels fall into maxRadius rings by their distance from the center of the box,
+    // radius 0 and 1 both show the innermost ring
+    int litRings = max(radius, 1);
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        int ring = (lightService->getCenterDistance(i) * maxRadius) >> 8;
+        if (ring >= litRings) {
+            continue;
         }
         
-        // Set LEDs if they're within bounds
-        if (leftPos >= 0) {
-            lightService->setLedColor(leftPos, CRGB(brightness, brightness, brightness));
-        }
-        if (rightPos < NUM_LEDS) {
-            lightService->setLedColor(rightPos, CRGB(brightness, brightness, brightness));
-        }
+        // Brighter at center, dimmer at edges
+        uint8_t brightness = 255 - ((ring * fadeStep[radius]) >> 8);
+        lightService->setLedColor(i, CRGB(brightness, brightness, brightness));
     }
 }
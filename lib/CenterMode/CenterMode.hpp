@@ -5,22 +5,24 @@
 
 class CenterMode : public AbstractMode {
     private:
-        unsigned long lastUpdate = 0;
         int currentRadius = 0;
         int maxRadius = 0;
         bool expanding = true;
         unsigned long normalInterval = 150; // Normal expansion speed
         unsigned long fastInterval = 50;    // Fast expansion during donation
         unsigned long currentInterval = 150;
+        // Brightness decrease per LED (8.8 fixed point) for each radius, built once
+        uint16_t fadeStep[(NUM_LEDS > 1 ? NUM_LEDS / 2 : 1) + 1];
         
     public:
         CenterMode(LightService* lightService, SpeakerService* speakerService);
         
         void donationTriggered() override;
-        void loop() override;
+        void renderFrame(unsigned long now, unsigned long dt) override;
         void setup() override;
         
     private:
+        void buildFadeTable();
         void updateExpansion();
         void setRadiusLEDs(int radius);
 };
@@ -2,51 +2,69 @@
 #include "Config.h"
 #include <Arduino.h>
 
+static const char chaseModeDescription[] PROGMEM = "Moving light with trailing tail effect";
+static const char chaseModeAuthor[] PROGMEM = "Friedjof";
+static const char chaseModeVersion[] PROGMEM = "v1.0.0";
+static const ModeInfo chaseModeInfo = {"Chase Light", chaseModeDescription, chaseModeAuthor, chaseModeVersion};
+
 ChaseMode::ChaseMode(LightService* lightService, SpeakerService* speakerService) 
-    : AbstractMode(lightService, speakerService, 2500,
-                  "Chase Light",
-                  "Moving light with trailing tail effect",
-                  "Friedjof",
-                  "v1.0.0") { // 2.5 second donation effect
+    : AbstractMode(lightService, speakerService, 2500, chaseModeInfo) { // 2.5 second donation effect
+    buildTailTable();
+}
+
+void ChaseMode::buildTailTable() {
+    // Tail gets dimmer as it gets further back (180 -> 30)
+    tailBrightness[0] = 255;
+    for (uint8_t i = 1; i <= TAIL_LENGTH; i++) {
+        int brightness = TAIL_LENGTH > 1 ? map(i, 1, TAIL_LENGTH, 180, 30) : 180;
+        tailBrightness[i] = constrain(brightness, 30, 180);
+    }
 }
 
 void ChaseMode::setup() {
     Serial.println("[ChaseMode] Initializing chase light mode");
     lightService->clear();
+    lightService->setBrightness(255); // The previous effect may have dimmed it
     currentPosition = 0;
     direction = 1;
     currentInterval = normalInterval;
-    lastUpdate = millis();
 }
 
 void ChaseMode::donationTriggered() {
     Serial.println("[ChaseMode] Donation detected - starting fast chase effect");
     startDonationEffect();
     
-    // Play donation sound
-    speakerService->playDonationSound();
+    // Play donation sound, the effect lasts as long as the clip
+    startDonationSound();
     
     // Speed up chase during donation
     currentInterval = fastInterval;
     
     // Optionally change direction for visual effect
     direction *= -1;
+    
+    // First step right away, the coin shows in the next frame
+    stepAccumulator = 0;
+    updateChase();
 }
 
-void ChaseMode::loop() {
-    unsigned long now = millis();
-    
+void ChaseMode::renderFrame(unsigned long now, unsigned long dt) {
     // Check if donation effect should end
-    if (isDonationEffectActive() && now - getDonationStartTime() >= getEffectDuration()) {
+    if (donationEffectDone(now)) {
         endDonationEffect();
         currentInterval = normalInterval; // Return to normal speed
         return;
     }
+
+    // Effect brightness follows the loudness of the clip
+    if (effectActive) {
+        lightService->setBrightness(effectIntensity(now));
+    }
     
     // Update chase animation
-    if (now - lastUpdate >= currentInterval) {
+    uint16_t steps = consumeSteps(dt, currentInterval);
+    while (steps--) {
         updateChase();
-        lastUpdate = now;
     }
 }
 
@@ -64,25 +82,18 @@ void ChaseMode::updateChase() {
     }
     
     drawChaser();
-    lightService->show();
 }
 
 void ChaseMode::drawChaser() {
     lightService->clear();
     
-    // Draw the main chaser LED (brightest)
-    lightService->setLedColor(currentPosition, CRGB(255, 255, 255));
-    
-    // Draw the tail behind the chaser
-    for (int i = 1; i <= tailLength; i++) {
+    // Draw the main chaser LED (index 0) and the tail behind it
+    for (int i = 0; i <= TAIL_LENGTH; i++) {
         int tailPos = currentPosition - (direction * i);
         
         // Make sure tail position is within bounds
         if (tailPos >= 0 && tailPos < NUM_LEDS) {
-            // Calculate brightness for tail (dimmer as it gets further back)
-            int brightness = map(i, 1, tailLength, 180, 30);
-            brightness = constrain(brightness, 30, 180);
-            
+            uint8_t brightness = tailBrightness[i];
             lightService->setLedColor(tailPos, CRGB(brightness, brightness, brightness));
         }
     }
@@ -5,10 +5,10 @@
 
 class ChaseMode : public AbstractMode {
     private:
-        unsigned long lastUpdate = 0;
         int currentPosition = 0;
         int direction = 1; // 1 for forward, -1 for backward
-        int tailLength = 3; // Number of LEDs in the tail
+        static const uint8_t TAIL_LENGTH = 3; // Number of LEDs in the tail
+        uint8_t tailBrightness[TAIL_LENGTH + 1]; // Brightness per tail index, built once
         unsigned long normalInterval = 120; // Normal chase speed
         unsigned long fastInterval = 40;    // Fast chase during donation
         unsigned long currentInterval = 120;
@@ -17,10 +17,11 @@ class ChaseMode : public AbstractMode {
         ChaseMode(LightService* lightService, SpeakerService* speakerService);
         
         void donationTriggered() override;
-        void loop() override;
+        void renderFrame(unsigned long now, unsigned long dt) override;
         void setup() override;
         
     private:
+        void buildTailTable();
         void updateChase();
         void drawChaser();
 };
@@ -1,28 +1,41 @@
 #include "Controller.hpp"
+#include "Profiler.hpp"
 
-void Controller::addMode(AbstractMode *mode) {
-    if (modeCount < MAX_MODES) {
-        modes[modeCount] = mode;
-        modeCount++;
-    } else {
-        Serial.println("[ERROR] Maximum number of modes reached!");
+bool Controller::addObserver(ControllerObserver* observer) {
+    if (observerCount >= MAX_OBSERVERS) {
+        Serial.println("[ERROR] Maximum number of observers reached!");
+        return false;
     }
+    observers[observerCount++] = observer;
+    return true;
 }
 
 void Controller::switchToNextMode() {
     switchNextMode();
 }
 
-String Controller::getCurrentModeName() const {
-    if (modeCount > 0 && currentModeIndex < modeCount) {
-        return modes[currentModeIndex]->getName();
+bool Controller::switchToMode(uint8_t index) {
+    if (index >= modeCount) {
+        return false;
+    }
+    switchMode(index);
+    return true;
+}
+
+void Controller::triggerDonation() {
+    registerDonation(millis());
+}
+
+const char* Controller::getModeName(uint8_t index) const {
+    if (index < modeCount) {
+        return modes[index]->getName();
     }
     return "none";
 }
 
 void Controller::switchMode(uint8_t index) {
     if (index < modeCount) {
-        String fromMode = getCurrentModeName();
+        uint8_t fromIndex = currentModeIndex;
         
         // Deactivate current mode
         if (modeCount > 0 && currentModeIndex < modeCount) {
@@ -32,15 +45,18 @@ void Controller::switchMode(uint8_t index) {
         currentModeIndex = index;
         
         // Activate new mode
-        String toMode = getCurrentModeName();
         modes[currentModeIndex]->activate();
         modes[currentModeIndex]->printModeInfo();
         
         Serial.print("[INFO] Switched to mode ");
         Serial.print(index);
         Serial.print(" (");
-        Serial.print(toMode);
+        Serial.print(getCurrentModeName());
         Serial.println(")");
+        
+        for (uint8_t i = 0; i < observerCount; i++) {
+            observers[i]->onModeChanged(fromIndex, index);
+        }
     } else {
         Serial.println("[ERROR] Invalid mode index");
     }
@@ -64,29 +80,86 @@ void Controller::setup() {
     } else {
         Serial.println("[WARNING] No modes registered");
     }
+    
+    lastFrameTime = millis();
+}
+
+void Controller::setTargetFps(uint8_t fps) {
+    if (fps == 0) {
+        return;
+    }
+    frameInterval = 1000 / fps;
+}
+
+unsigned long Controller::timeUntilNextFrame() const {
+    unsigned long elapsed = millis() - lastFrameTime;
+    return elapsed >= frameInterval ? 0 : frameInterval - elapsed;
 }
 
 void Controller::loop() {
     if (modeCount == 0) return;
 
-    // Check for sensor state changes
-    if (sensorService->risingEdge() && millis() - lastSensorCheck > this->modes[currentModeIndex]->getEffectDuration()) {
-        lastSensorCheck = millis();
+    // Switch before handling new coins, so they start an effect in the next mode
+    if (!modes[currentModeIndex]->isActive()) {
+        switchNextMode();
+    }
 
-        String currentModeName = getCurrentModeName();
-        Serial.println("[INFO] Donation detected! Mode: " + currentModeName);
-        
-        // Trigger donation effect
-        modes[currentModeIndex]->donationTriggered();
-        
-        // Set global flag for MQTT notification
-        extern bool donationJustDetected;
-        donationJustDetected = true;
+    // Drain every edge captured since the last pass
+    SensorEdge edge;
+    while (sensorService->popEdge(edge)) {
+        if (edge.rising) {
+            registerDonation(edge.timestampMs);
+        }
     }
 
-    if (modes[currentModeIndex]->isActive()) {
-        modes[currentModeIndex]->loop();
+    // End donation effects together with their sound
+    uint16_t finishedTrack;
+    while (speakerService->popFinished(finishedTrack)) {
+        modes[currentModeIndex]->soundFinished(finishedTrack);
+    }
+
+    // Render the active mode at a fixed frame rate
+    unsigned long now = millis();
+    unsigned long dt = now - lastFrameTime;
+    if (dt < frameInterval) {
+        return;
+    }
+    lastFrameTime = now;
+    PROFILE_FRAME(dt, frameInterval);
+    
+    // Don't fast-forward animations after long blocking calls (WiFi, DFPlayer)
+    if (dt > MAX_FRAME_DT) {
+        dt = MAX_FRAME_DT;
+    }
+    
+    modes[currentModeIndex]->renderFrame(now, dt);
+}
+
+void Controller::registerDonation(unsigned long timestampMs) {
+    // Bounce that outlasted the sensor debounce, not a second coin
+    if (donationSeen && timestampMs - lastDonationTime < DONATION_MIN_INTERVAL_MS) {
+        return;
+    }
+    donationSeen = true;
+    lastDonationTime = timestampMs;
+
+    AbstractMode* mode = modes[currentModeIndex];
+    
+    if (mode->isDonationEffectActive()) {
+        // A burst of coins joins the running effect instead of restarting
+        // it, so the box switches modes once per burst
+        mode->addDonation();
+        Serial.print("[INFO] Donation added to the running effect: ");
+        Serial.print(mode->getDonationAmount());
+        Serial.println(" coins");
     } else {
-        switchNextMode();
+        Serial.print("[INFO] Donation detected! Mode: ");
+        Serial.println(getCurrentModeName());
+        mode->donationTriggered();
+    }
+    
+    // Every coin is reported
+    for (uint8_t i = 0; i < observerCount; i++) {
+        observers[i]->onDonation(currentModeIndex, timestampMs);
     }
-}
\ No newline at end of file
+}
@@ -4,37 +4,59 @@
 #include <Arduino.h>
 
 #include "AbstractMode.hpp"
+#include "ControllerObserver.hpp"
 #include "SensorService.hpp"
 #include "SpeakerService.hpp"
 
-#define MAX_MODES 10  // Maximum number of modes
+#define MAX_OBSERVERS 4 // Maximum number of event observers
 
 class Controller {
     private:
-        AbstractMode* modes[MAX_MODES];
-        uint8_t modeCount = 0;
+        // Fixed list in static storage, see the constructor
+        AbstractMode* const* modes;
+        uint8_t modeCount;
         uint8_t currentModeIndex = 0;
 
-        uint64_t lastSensorCheck = 0; // Track last mode switch time
+        ControllerObserver* observers[MAX_OBSERVERS];
+        uint8_t observerCount = 0;
+
+        unsigned long lastDonationTime = 0; // Time of the last counted coin
+        bool donationSeen = false;
+
+        // Frame clock
+        unsigned long frameInterval = 1000 / TARGET_FPS;
+        unsigned long lastFrameTime = 0;
 
         SensorService* sensorService;
         SpeakerService* speakerService;
 
         void switchMode(uint8_t index);
         void switchNextMode();
+        void registerDonation(unsigned long timestampMs);
         
     public:
-        Controller(SensorService* sensorService, SpeakerService* speakerService)
-            : sensorService(sensorService), speakerService(speakerService) {}
+        // The mode array is not copied and must outlive the Controller
+        template <size_t N>
+        Controller(SensorService* sensorService, SpeakerService* speakerService, AbstractMode* const (&modes)[N])
+            : modes(modes), modeCount(N), sensorService(sensorService), speakerService(speakerService) {
+            static_assert(N > 0 && N <= 255, "Controller needs between 1 and 255 modes");
+        }
 
-        void addMode(AbstractMode *mode);
+        bool addObserver(ControllerObserver* observer);
         void switchToNextMode(); // Public method to manually switch modes
+        bool switchToMode(uint8_t index); // False if there is no such mode
+        void triggerDonation(); // Test donation, same effect and events as a coin
 
         void setup();
         void loop();
+
+        // Frame clock
+        void setTargetFps(uint8_t fps);
+        unsigned long timeUntilNextFrame() const;
         
         // Public getters for MQTT integration
-        String getCurrentModeName() const;
+        const char* getCurrentModeName() const { return getModeName(currentModeIndex); }
+        const char* getModeName(uint8_t index) const;
         uint8_t getModeCount() const { return modeCount; }
         uint8_t getCurrentModeIndex() const { return currentModeIndex; }
 };
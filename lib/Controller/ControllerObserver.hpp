@@ -0,0 +1,20 @@
+#ifndef CONTROLLER_OBSERVER_HPP
+#define CONTROLLER_OBSERVER_HPP
+
+#include <Arduino.h>
+
+/**
+ * ControllerObserver - pushed Controller events, identified by mode index
+ * Called from Controller::loop() on the render side, so implementations
+ * must return quickly (record the event, hand it over, never publish).
+ * Use Controller::getModeName() to turn an index into a name.
+ */
+class ControllerObserver {
+    public:
+        virtual ~ControllerObserver() {}
+
+        virtual void onModeChanged(uint8_t fromIndex, uint8_t toIndex) {}
+        virtual void onDonation(uint8_t modeIndex, unsigned long timestampMs) {}
+};
+
+#endif // CONTROLLER_OBSERVER_HPP
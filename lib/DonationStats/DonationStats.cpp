@@ -0,0 +1,173 @@
+#include "DonationStats.hpp"
+
+#if !defined(NATIVE)
+#include <LittleFS.h>
+
+static const char* STATS_FILE = "/stats.bin";
+static const char* STATS_TEMP_FILE = "/stats.tmp";
+static const uint16_t STATS_MAGIC = 0xD57A;
+static const uint8_t STATS_VERSION = 1;
+
+// Lasting part of DonationSummary as stored in flash
+struct StoredStats {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t modes;
+    uint32_t total;
+    uint16_t peakHour;
+    uint16_t peakMinute;
+    uint32_t perMode[DONATION_STATS_MODES];
+};
+#endif
+
+// Counters are written on the render core and copied from the I/O core
+#if ENABLE_DUAL_CORE
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+#define STATS_ENTER_CRITICAL() portENTER_CRITICAL(&statsMux)
+#define STATS_EXIT_CRITICAL()  portEXIT_CRITICAL(&statsMux)
+#else
+#define STATS_ENTER_CRITICAL()
+#define STATS_EXIT_CRITICAL()
+#endif
+
+static const unsigned long MINUTE_MS = 60000;
+
+DonationStats::DonationStats() {
+    memset(&summary, 0, sizeof(summary));
+    memset(minuteBuckets, 0, sizeof(minuteBuckets));
+}
+
+void DonationStats::setup() {
+    load();
+    currentMinute = millis() / MINUTE_MS;
+    lastPersist = millis();
+}
+
+void DonationStats::rotate(unsigned long now) {
+    uint32_t minute = now / MINUTE_MS;
+    // A sensor edge can be stamped before the minute loop() already rotated
+    // to, it counts in the current bucket. Far behind means millis() wrapped.
+    if (minute <= currentMinute && currentMinute - minute < 60) {
+        return;
+    }
+    
+    // Clear the buckets of the minutes that passed, at most the whole hour
+    uint32_t passed = min(minute - currentMinute, (uint32_t)60);
+    for (uint32_t i = 1; i <= passed; i++) {
+        uint16_t& bucket = minuteBuckets[(currentMinute + i) % 60];
+        if (bucket > 0) {
+            summary.lastHour -= bucket;
+            bucket = 0;
+            summary.revision++;
+        }
+    }
+    currentMinute = minute;
+}
+
+void DonationStats::onDonation(uint8_t modeIndex, unsigned long timestampMs) {
+    STATS_ENTER_CRITICAL();
+    rotate(timestampMs);
+    
+    uint16_t& bucket = minuteBuckets[currentMinute % 60];
+    bucket++;
+    summary.lastHour++;
+    summary.total++;
+    summary.sinceBoot++;
+    summary.perMode[min(modeIndex, (uint8_t)(DONATION_STATS_MODES - 1))]++;
+    summary.peakMinute = max(summary.peakMinute, bucket);
+    summary.peakHour = max(summary.peakHour, summary.lastHour);
+    summary.revision++;
+    STATS_EXIT_CRITICAL();
+    
+    dirty = true;
+}
+
+void DonationStats::loop() {
+    unsigned long now = millis();
+    
+    STATS_ENTER_CRITICAL();
+    rotate(now);
+    STATS_EXIT_CRITICAL();
+    
+    // Batch all donations of one interval into a single flash write
+    if (dirty && now - lastPersist >= DONATION_STATS_PERSIST_INTERVAL) {
+        persist();
+        lastPersist = now;
+        dirty = false;
+    }
+}
+
+void DonationStats::snapshot(DonationSummary& target) const {
+    STATS_ENTER_CRITICAL();
+    target = summary;
+    STATS_EXIT_CRITICAL();
+}
+
+void DonationStats::persist() {
+#if !defined(NATIVE)
+    StoredStats stored;
+    stored.magic = STATS_MAGIC;
+    stored.version = STATS_VERSION;
+    stored.modes = DONATION_STATS_MODES;
+    stored.total = summary.total;
+    stored.peakHour = summary.peakHour;
+    stored.peakMinute = summary.peakMinute;
+    memcpy(stored.perMode, summary.perMode, sizeof(stored.perMode));
+    
+    // Write a new file and swap it in, a reset during the write keeps the old counters
+    File file = LittleFS.open(STATS_TEMP_FILE, "w");
+    if (!file) {
+        Serial.println("[DonationStats] Unable to write statistics file");
+        return;
+    }
+    size_t written = file.write((const uint8_t*)&stored, sizeof(stored));
+    file.close();
+    
+    if (written != sizeof(stored)) {
+        Serial.println("[DonationStats] Statistics file incomplete, keeping the previous one");
+        return;
+    }
+    LittleFS.remove(STATS_FILE);
+    LittleFS.rename(STATS_TEMP_FILE, STATS_FILE);
+#endif
+}
+
+void DonationStats::load() {
+#if !defined(NATIVE)
+#ifdef ESP32
+    if (!LittleFS.begin(true)) {
+#else
+    if (!LittleFS.begin()) {
+#endif
+        Serial.println("[DonationStats] LittleFS unavailable - statistics are RAM only");
+        return;
+    }
+    
+    // A missing file after a reset during the swap leaves the temp file complete
+    const char* path = LittleFS.exists(STATS_FILE) ? STATS_FILE : STATS_TEMP_FILE;
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        return;
+    }
+    
+    StoredStats stored;
+    size_t read = file.read((uint8_t*)&stored, sizeof(stored));
+    file.close();
+    
+    if (read != sizeof(stored) || stored.magic != STATS_MAGIC ||
+        stored.version != STATS_VERSION || stored.modes != DONATION_STATS_MODES) {
+        Serial.println("[DonationStats] Ignoring incompatible statistics file");
+        return;
+    }
+    
+    summary.total = stored.total;
+    summary.peakHour = stored.peakHour;
+    summary.peakMinute = stored.peakMinute;
+    memcpy(summary.perMode, stored.perMode, sizeof(summary.perMode));
+    summary.revision++;
+    
+    Serial.print("[DonationStats] Restored ");
+    Serial.print(summary.total);
+    Serial.println(" donations");
+#endif
+}
@@ -0,0 +1,51 @@
+#ifndef DONATION_STATS_HPP
+#define DONATION_STATS_HPP
+
+#include <Arduino.h>
+
+#include "Config.h"
+#include "ControllerObserver.hpp"
+
+struct DonationSummary {
+    uint32_t total;                          // All donations, kept across reboots
+    uint32_t sinceBoot;
+    uint16_t lastHour;                       // Rolling 60 minute window
+    uint16_t peakHour;                       // Highest lastHour ever seen
+    uint16_t peakMinute;                     // Most donations within one minute
+    uint32_t perMode[DONATION_STATS_MODES];  // By mode index, the last slot also counts higher indices
+    uint32_t revision;                       // Changes whenever one of the values above does
+};
+
+/**
+ * DonationStats - donation counters kept on the device
+ * Counts every donation the Controller reports, keeps a rolling hour of
+ * one-minute buckets and writes the lasting counters to LittleFS at most
+ * every DONATION_STATS_PERSIST_INTERVAL, so flash wear does not grow with
+ * the donation rate.
+ */
+class DonationStats : public ControllerObserver {
+    private:
+        DonationSummary summary;
+        uint16_t minuteBuckets[60];
+        uint32_t currentMinute = 0; // Uptime minute of the bucket that counts now
+        bool dirty = false;         // Lasting counters changed since the last write
+        unsigned long lastPersist = 0;
+
+        void rotate(unsigned long now);
+        void persist();
+        void load();
+
+    public:
+        DonationStats();
+
+        void setup();
+        // Call from the render loop next to the Controller, writes to flash when due
+        void loop();
+
+        void onDonation(uint8_t modeIndex, unsigned long timestampMs) override;
+
+        // Consistent copy, may be called from the I/O core
+        void snapshot(DonationSummary& target) const;
+};
+
+#endif // DONATION_STATS_HPP
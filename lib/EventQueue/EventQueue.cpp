@@ -0,0 +1,130 @@
+#include "EventQueue.hpp"
+
+#if EVENT_QUEUE_PERSIST
+#include <LittleFS.h>
+
+static const char* EVENT_QUEUE_FILE = "/events.bin";
+static const uint16_t EVENT_QUEUE_MAGIC = 0xE51A;
+static const uint8_t EVENT_QUEUE_VERSION = 1;
+#endif
+
+static void copyName(char* target, const char* source) {
+    strncpy(target, source, MODE_NAME_LENGTH - 1);
+    target[MODE_NAME_LENGTH - 1] = '\0';
+}
+
+void EventQueue::setup() {
+    head = 0;
+    count = 0;
+    dropped = 0;
+    load();
+}
+
+EventQueue::Event& EventQueue::pushSlot() {
+    if (count == EVENT_QUEUE_SIZE) {
+        // Full - overwrite the oldest event
+        head = (head + 1) % EVENT_QUEUE_SIZE;
+        count--;
+        dropped++;
+    }
+    
+    Event& event = events[(head + count) % EVENT_QUEUE_SIZE];
+    count++;
+    memset(&event, 0, sizeof(Event));
+    event.timestamp = millis();
+    return event;
+}
+
+void EventQueue::pushDonation(const char* mode, uint16_t amount) {
+    Event& event = pushSlot();
+    event.type = EVENT_DONATION;
+    event.amount = amount;
+    copyName(event.mode, mode);
+    persist();
+}
+
+void EventQueue::pushModeChange(const char* fromMode, const char* toMode) {
+    Event& event = pushSlot();
+    event.type = EVENT_MODE_CHANGE;
+    copyName(event.fromMode, fromMode);
+    copyName(event.mode, toMode);
+    persist();
+}
+
+const EventQueue::Event* EventQueue::peek(uint8_t offset) const {
+    if (offset >= count) {
+        return nullptr;
+    }
+    return &events[(head + offset) % EVENT_QUEUE_SIZE];
+}
+
+void EventQueue::pop(uint8_t n) {
+    if (n > count) {
+        n = count;
+    }
+    head = (head + n) % EVENT_QUEUE_SIZE;
+    count -= n;
+    persist();
+}
+
+void EventQueue::persist() {
+#if EVENT_QUEUE_PERSIST
+    if (count == 0) {
+        LittleFS.remove(EVENT_QUEUE_FILE);
+        return;
+    }
+    
+    File file = LittleFS.open(EVENT_QUEUE_FILE, "w");
+    if (!file) {
+        Serial.println("[EventQueue] Unable to write queue file");
+        return;
+    }
+    
+    file.write((const uint8_t*)&EVENT_QUEUE_MAGIC, sizeof(EVENT_QUEUE_MAGIC));
+    file.write(&EVENT_QUEUE_VERSION, 1);
+    file.write(&count, 1);
+    for (uint8_t i = 0; i < count; i++) {
+        file.write((const uint8_t*)peek(i), sizeof(Event));
+    }
+    file.close();
+#endif
+}
+
+void EventQueue::load() {
+#if EVENT_QUEUE_PERSIST
+#ifdef ESP32
+    if (!LittleFS.begin(true)) {
+#else
+    if (!LittleFS.begin()) {
+#endif
+        Serial.println("[EventQueue] LittleFS unavailable - queue is RAM only");
+        return;
+    }
+    
+    File file = LittleFS.open(EVENT_QUEUE_FILE, "r");
+    if (!file) {
+        return;
+    }
+    
+    uint16_t magic = 0;
+    uint8_t version = 0;
+    uint8_t stored = 0;
+    file.read((uint8_t*)&magic, sizeof(magic));
+    file.read(&version, 1);
+    file.read(&stored, 1);
+    
+    if (magic == EVENT_QUEUE_MAGIC && version == EVENT_QUEUE_VERSION) {
+        Event event;
+        while (stored-- > 0 && file.read((uint8_t*)&event, sizeof(Event)) == sizeof(Event)) {
+            event.flags |= FLAG_PREVIOUS_BOOT;
+            Event& slot = pushSlot();
+            slot = event;
+        }
+    }
+    file.close();
+    
+    Serial.print("[EventQueue] Restored ");
+    Serial.print(count);
+    Serial.println(" queued events");
+#endif
+}
@@ -0,0 +1,64 @@
+#ifndef EVENT_QUEUE_HPP
+#define EVENT_QUEUE_HPP
+
+#include <Arduino.h>
+
+#include "Config.h"
+
+/**
+ * Event Queue - bounded ring buffer for MQTT events
+ * Keeps donation and mode change events while the broker is unreachable,
+ * optionally persisted to LittleFS so they survive a reboot
+ */
+class EventQueue {
+    public:
+        enum EventType : uint8_t {
+            EVENT_DONATION = 0,
+            EVENT_MODE_CHANGE = 1
+        };
+
+        enum EventFlags : uint8_t {
+            FLAG_PREVIOUS_BOOT = 0x01 // Restored from flash, timestamp belongs to an earlier boot
+        };
+
+        struct Event {
+            uint32_t timestamp;             // millis() when the event happened
+            uint16_t amount;                // Donation amount (donations only)
+            uint8_t type;                   // EventType
+            uint8_t flags;                  // EventFlags
+            char mode[MODE_NAME_LENGTH];    // Donation mode / target mode of a change
+            char fromMode[MODE_NAME_LENGTH];// Previous mode (mode changes only)
+        };
+
+    private:
+        Event events[EVENT_QUEUE_SIZE];
+        uint8_t head = 0;  // Index of the oldest event
+        uint8_t count = 0;
+        uint16_t dropped = 0;
+
+        void persist();
+        void load();
+
+    public:
+        EventQueue() {}
+
+        void setup();
+
+        // Queueing - the oldest event is overwritten when full
+        void pushDonation(const char* mode, uint16_t amount);
+        void pushModeChange(const char* fromMode, const char* toMode);
+
+        // Replay - peek events in order, pop once they were published
+        const Event* peek(uint8_t offset = 0) const;
+        void pop(uint8_t n = 1);
+
+        uint8_t size() const { return count; }
+        bool isEmpty() const { return count == 0; }
+        uint16_t getDropped() const { return dropped; }
+        void resetDropped() { dropped = 0; }
+
+    private:
+        Event& pushSlot();
+};
+
+#endif // EVENT_QUEUE_HPP
@@ -0,0 +1,34 @@
+#ifndef AUDIO_PLAYER_HPP
+#define AUDIO_PLAYER_HPP
+
+#include <Arduino.h>
+
+/**
+ * Audio Player - hardware interface behind SpeakerService
+ * Mirrors the DFRobotDFPlayerMini calls SpeakerService uses; message
+ * types and values are the DFRobotDFPlayerMini constants
+ */
+class AudioPlayer {
+    public:
+        virtual ~AudioPlayer() {}
+
+        // Open the serial link and start the module
+        virtual bool begin() = 0;
+        virtual void setTimeOut(unsigned long timeoutMs) = 0;
+
+        // Incoming messages (ACK timeouts, errors, card events)
+        virtual bool available() = 0;
+        virtual uint8_t readType() = 0;
+        virtual int read() = 0;
+
+        virtual void play(int track) = 0;
+        virtual void volume(uint8_t volume) = 0;
+        virtual void pause() = 0;
+        virtual void start() = 0;
+        virtual void stop() = 0;
+        virtual void next() = 0;
+        virtual void previous() = 0;
+        virtual void reset() = 0;
+};
+
+#endif // AUDIO_PLAYER_HPP
@@ -0,0 +1,34 @@
+#ifndef NATIVE
+
+#include "DfPlayerAudio.hpp"
+
+DfPlayerAudio::DfPlayerAudio()
+#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))
+    : softSerial(DFPLAYER_RX, DFPLAYER_TX)
+#endif
+{
+}
+
+bool DfPlayerAudio::begin() {
+#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))
+    softSerial.begin(DFPLAYER_BAUD_RATE);
+    
+    // Initialize DFPlayer with software serial - exactly like the example
+    return myDFPlayer.begin(softSerial, /*isACK = */true, /*doReset = */false);
+    
+#elif defined(ESP32)
+    // ESP32 hardware serial configuration
+    Serial1.begin(DFPLAYER_BAUD_RATE, SERIAL_8N1, DFPLAYER_RX, DFPLAYER_TX);
+    
+    // Initialize DFPlayer with hardware serial
+    return myDFPlayer.begin(Serial1, /*isACK = */true, /*doReset = */false);
+    
+#else
+    // Default hardware serial
+    Serial1.begin(DFPLAYER_BAUD_RATE);
+    
+    return myDFPlayer.begin(Serial1, /*isACK = */true, /*doReset = */true);
+#endif
+}
+
+#endif // NATIVE
@@ -0,0 +1,44 @@
+#ifndef DF_PLAYER_AUDIO_HPP
+#define DF_PLAYER_AUDIO_HPP
+
+#ifndef NATIVE
+
+#include "AudioPlayer.hpp"
+#include "Config.h"
+#include "DFRobotDFPlayerMini.h"
+
+#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))   // Using a soft serial port
+#include <SoftwareSerial.h>
+#endif
+
+// DFPlayer Mini on DFPLAYER_RX/DFPLAYER_TX
+class DfPlayerAudio : public AudioPlayer {
+    private:
+#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))
+        SoftwareSerial softSerial;
+#endif
+        DFRobotDFPlayerMini myDFPlayer;
+
+    public:
+        DfPlayerAudio();
+
+        bool begin() override;
+        void setTimeOut(unsigned long timeoutMs) override { myDFPlayer.setTimeOut(timeoutMs); }
+
+        bool available() override { return myDFPlayer.available(); }
+        uint8_t readType() override { return myDFPlayer.readType(); }
+        int read() override { return myDFPlayer.read(); }
+
+        void play(int track) override { myDFPlayer.play(track); }
+        void volume(uint8_t volume) override { myDFPlayer.volume(volume); }
+        void pause() override { myDFPlayer.pause(); }
+        void start() override { myDFPlayer.start(); }
+        void stop() override { myDFPlayer.stop(); }
+        void next() override { myDFPlayer.next(); }
+        void previous() override { myDFPlayer.previous(); }
+        void reset() override { myDFPlayer.reset(); }
+};
+
+#endif // NATIVE
+
+#endif // DF_PLAYER_AUDIO_HPP
@@ -0,0 +1,34 @@
+#ifndef NATIVE
+
+#include "FastLedDriver.hpp"
+
+void FastLedDriver::begin(CRGB* leds, uint16_t count) {
+    // One controller per strip on consecutive slices of the buffer, the pin is a template argument
+    uint16_t length = count / LED_STRIP_COUNT;
+    FastLED.addLeds<LED_TYPE, DATA_PIN>(leds, length);
+#if LED_STRIP_COUNT >= 2
+    FastLED.addLeds<LED_TYPE, DATA_PIN_2>(leds + length, length);
+#endif
+#if LED_STRIP_COUNT >= 3
+    FastLED.addLeds<LED_TYPE, DATA_PIN_3>(leds + 2 * length, length);
+#endif
+#if LED_STRIP_COUNT >= 4
+    FastLED.addLeds<LED_TYPE, DATA_PIN_4>(leds + 3 * length, length);
+#endif
+#if LED_STRIP_COUNT >= 5
+    FastLED.addLeds<LED_TYPE, DATA_PIN_5>(leds + 4 * length, length);
+#endif
+#if LED_STRIP_COUNT >= 6
+    FastLED.addLeds<LED_TYPE, DATA_PIN_6>(leds + 5 * length, length);
+#endif
+}
+
+void FastLedDriver::setBrightness(uint8_t brightness) {
+    FastLED.setBrightness(brightness);
+}
+
+void FastLedDriver::show() {
+    FastLED.show();
+}
+
+#endif // NATIVE
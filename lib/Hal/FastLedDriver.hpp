@@ -0,0 +1,19 @@
+#ifndef FAST_LED_DRIVER_HPP
+#define FAST_LED_DRIVER_HPP
+
+#ifndef NATIVE
+
+#include "LedDriver.hpp"
+#include "Config.h"
+
+// WS2812B strip on DATA_PIN via FastLED
+class FastLedDriver : public LedDriver {
+    public:
+        void begin(CRGB* leds, uint16_t count) override;
+        void setBrightness(uint8_t brightness) override;
+        void show() override;
+};
+
+#endif // NATIVE
+
+#endif // FAST_LED_DRIVER_HPP
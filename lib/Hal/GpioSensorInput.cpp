@@ -0,0 +1,34 @@
+#ifndef NATIVE
+
+#include "GpioSensorInput.hpp"
+
+uint8_t GpioSensorInput::interruptPin = 0;
+SensorInput::LevelHandler GpioSensorInput::levelHandler = nullptr;
+
+void GpioSensorInput::begin() {
+    pinMode(pin, INPUT_PULLUP);
+}
+
+uint8_t GpioSensorInput::read() {
+    return digitalRead(pin);
+}
+
+bool GpioSensorInput::attachChangeHandler(LevelHandler handler) {
+    int interrupt = digitalPinToInterrupt(pin);
+    if (interrupt < 0) {
+        return false;
+    }
+    
+    interruptPin = pin;
+    levelHandler = handler;
+    attachInterrupt(interrupt, handleInterrupt, CHANGE);
+    return true;
+}
+
+void IRAM_ATTR GpioSensorInput::handleInterrupt() {
+    if (levelHandler) {
+        levelHandler(digitalRead(interruptPin));
+    }
+}
+
+#endif // NATIVE
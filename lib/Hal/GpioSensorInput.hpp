@@ -0,0 +1,28 @@
+#ifndef GPIO_SENSOR_INPUT_HPP
+#define GPIO_SENSOR_INPUT_HPP
+
+#ifndef NATIVE
+
+#include "SensorInput.hpp"
+
+// TCRT5000 on a GPIO with pull-up, CHANGE interrupt where the pin supports it
+class GpioSensorInput : public SensorInput {
+    private:
+        uint8_t pin;
+
+        // The ISR cannot go through the vtable (flash), keep what it needs in RAM
+        static uint8_t interruptPin;
+        static LevelHandler levelHandler;
+        static void IRAM_ATTR handleInterrupt();
+
+    public:
+        GpioSensorInput(uint8_t pin) : pin(pin) {}
+
+        void begin() override;
+        uint8_t read() override;
+        bool attachChangeHandler(LevelHandler handler) override;
+};
+
+#endif // NATIVE
+
+#endif // GPIO_SENSOR_INPUT_HPP
@@ -0,0 +1,21 @@
+#ifndef LED_DRIVER_HPP
+#define LED_DRIVER_HPP
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+/**
+ * LED Driver - hardware interface behind LightService
+ * LightService owns the pixel buffer, the driver only pushes it out
+ */
+class LedDriver {
+    public:
+        virtual ~LedDriver() {}
+
+        // Called once with the buffer that show() will push
+        virtual void begin(CRGB* leds, uint16_t count) = 0;
+        virtual void setBrightness(uint8_t brightness) = 0;
+        virtual void show() = 0;
+};
+
+#endif // LED_DRIVER_HPP
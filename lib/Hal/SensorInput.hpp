@@ -0,0 +1,24 @@
+#ifndef SENSOR_INPUT_HPP
+#define SENSOR_INPUT_HPP
+
+#include <Arduino.h>
+
+/**
+ * Sensor Input - hardware interface behind SensorService
+ * Delivers the raw (undebounced) level of the donation sensor
+ */
+class SensorInput {
+    public:
+        // Called from interrupt context with the new level
+        typedef void (*LevelHandler)(uint8_t level);
+
+        virtual ~SensorInput() {}
+
+        virtual void begin() = 0;
+        virtual uint8_t read() = 0;
+
+        // Report every level change to handler, false if only polling is possible
+        virtual bool attachChangeHandler(LevelHandler handler) = 0;
+};
+
+#endif // SENSOR_INPUT_HPP
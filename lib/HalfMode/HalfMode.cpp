@@ -2,12 +2,13 @@
 #include "Config.h"
 #include <Arduino.h>
 
+static const char halfModeDescription[] PROGMEM = "Alternating first and second half illumination";
+static const char halfModeAuthor[] PROGMEM = "Friedjof";
+static const char halfModeVersion[] PROGMEM = "v1.0.0";
+static const ModeInfo halfModeInfo = {"Half Switch", halfModeDescription, halfModeAuthor, halfModeVersion};
+
 HalfMode::HalfMode(LightService* lightService, SpeakerService* speakerService) 
-    : AbstractMode(lightService, speakerService,
-                  "Half Switch",
-                  "Alternating first and second half illumination",
-                  "Friedjof",
-                  "v1.0.0") {
+    : AbstractMode(lightService, speakerService, halfModeInfo) {
 }
 
 void HalfMode::setup() {
@@ -20,7 +21,6 @@ void HalfMode::setup() {
     
     showFirstHalf = true;
     currentInterval = normalInterval;
-    lastUpdate = millis();
     
     // Start with first half
     updateHalves();
@@ -32,48 +32,46 @@ void HalfMode::donationTriggered() {
     // Start donation effect
     startDonationEffect();
     
-    // Play donation sound
-    speakerService->playDonationSound();
+    // Play donation sound, the effect lasts as long as the clip
+    startDonationSound();
     
     // Speed up switching
     currentInterval = fastInterval;
+    
+    // First switch right away, the coin shows in the next frame
+    stepAccumulator = 0;
+    showFirstHalf = !showFirstHalf;
+    updateHalves();
 }
 
-void HalfMode::loop() {
-    unsigned long currentTime = millis();
-    
+void HalfMode::renderFrame(unsigned long now, unsigned long dt) {
     // Check if donation effect should end
-    if (effectActive && currentTime - effectStartTime >= effectDuration) {
+    if (donationEffectDone(now)) {
         endDonationEffect();
         currentInterval = normalInterval; // Reset to normal speed
         Serial.println("[INFO] HalfMode donation effect ended - mode will deactivate");
     }
+
+    // Effect brightness follows the loudness of the clip
+    if (effectActive) {
+        lightService->setBrightness(effectIntensity(now));
+    }
     
     // Switch between halves timing
-    if (currentTime - lastUpdate >= currentInterval) {
-        lastUpdate = currentTime;
-        showFirstHalf = !showFirstHalf;
+    uint16_t steps = consumeSteps(dt, currentInterval);
+    if (steps > 0) {
+        // An even number of switches ends on the same half
+        if (steps % 2 == 1) {
+            showFirstHalf = !showFirstHalf;
+        }
         updateHalves();
     }
 }
 
 void HalfMode::updateHalves() {
-    // Clear all LEDs first
-    for (int i = 0; i < NUM_LEDS; i++) {
-        lightService->setLedColor(i, CRGB::Black);
-    }
-    
-    int halfPoint = NUM_LEDS / 2;
-    
-    if (showFirstHalf) {
-        // Light up first half
-        for (int i = 0; i < halfPoint; i++) {
-            lightService->setLedColor(i, CRGB::White);
-        }
-    } else {
-        // Light up second half
-        for (int i = halfPoint; i < NUM_LEDS; i++) {
-            lightService->setLedColor(i, CRGB::White);
-        }
+    // The box is split at its center plane (x = 0), pixels on the plane count as second half
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        bool firstHalf = lightService->getPosition(i).x < 0;
+        lightService->setLedColor(i, firstHalf == showFirstHalf ? CRGB::White : CRGB::Black);
     }
 }
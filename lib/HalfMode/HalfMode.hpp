@@ -5,7 +5,6 @@
 
 class HalfMode : public AbstractMode {
     private:
-        unsigned long lastUpdate = 0;
         bool showFirstHalf = true;
         unsigned long normalInterval = 1500; // Switch every 1.5 seconds
         unsigned long fastInterval = 300;    // Fast switching during donation
@@ -15,7 +14,7 @@ class HalfMode : public AbstractMode {
         HalfMode(LightService* lightService, SpeakerService* speakerService);
         
         void donationTriggered() override;
-        void loop() override;
+        void renderFrame(unsigned long now, unsigned long dt) override;
         void setup() override;
         
     private:
@@ -0,0 +1,171 @@
+#include "JsonWriter.hpp"
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity)
+    : buffer(buffer), capacity(capacity) {
+    reset();
+}
+
+void JsonWriter::reset() {
+    length = 0;
+    overflow = false;
+    depth = 0;
+    hasMembers = 0;
+    if (capacity > 0) {
+        buffer[0] = '\0';
+    }
+}
+
+void JsonWriter::append(char c) {
+    // Always keep room for the terminator
+    if (length + 1 >= capacity) {
+        overflow = true;
+        return;
+    }
+    buffer[length++] = c;
+    buffer[length] = '\0';
+}
+
+void JsonWriter::append(const char* text) {
+    while (*text) {
+        append(*text++);
+    }
+}
+
+void JsonWriter::appendEscaped(const char* text) {
+    append('"');
+    for (; text && *text; text++) {
+        char c = *text;
+        switch (c) {
+            case '"':  append("\\\""); break;
+            case '\\': append("\\\\"); break;
+            case '\n': append("\\n"); break;
+            case '\r': append("\\r"); break;
+            case '\t': append("\\t"); break;
+            default:
+                // Drop other control characters
+                if ((uint8_t)c >= 0x20) {
+                    append(c);
+                }
+                break;
+        }
+    }
+    append('"');
+}
+
+void JsonWriter::separator() {
+    uint8_t bit = 1 << depth;
+    if (hasMembers & bit) {
+        append(',');
+    }
+    hasMembers |= bit;
+}
+
+void JsonWriter::key(const char* name) {
+    separator();
+    appendEscaped(name);
+    append(':');
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    if (depth > 0) {
+        separator();
+    }
+    append('{');
+    if (depth + 1 < MAX_DEPTH) {
+        depth++;
+    }
+    hasMembers &= ~(1 << depth);
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginObject(const char* name) {
+    key(name);
+    append('{');
+    if (depth + 1 < MAX_DEPTH) {
+        depth++;
+    }
+    hasMembers &= ~(1 << depth);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    if (depth > 0) {
+        depth--;
+    }
+    append('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    if (depth > 0) {
+        separator();
+    }
+    append('[');
+    if (depth + 1 < MAX_DEPTH) {
+        depth++;
+    }
+    hasMembers &= ~(1 << depth);
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(const char* name) {
+    key(name);
+    append('[');
+    if (depth + 1 < MAX_DEPTH) {
+        depth++;
+    }
+    hasMembers &= ~(1 << depth);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    if (depth > 0) {
+        depth--;
+    }
+    append(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, const char* value) {
+    key(name);
+    appendEscaped(value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, bool value) {
+    key(name);
+    append(value ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, long value) {
+    char number[21];
+    snprintf(number, sizeof(number), "%ld", value);
+    key(name);
+    append(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(const char* name, unsigned long value) {
+    char number[21];
+    snprintf(number, sizeof(number), "%lu", value);
+    key(name);
+    append(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long value) {
+    char number[21];
+    snprintf(number, sizeof(number), "%ld", value);
+    separator();
+    append(number);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long value) {
+    char number[21];
+    snprintf(number, sizeof(number), "%lu", value);
+    separator();
+    append(number);
+    return *this;
+}
@@ -0,0 +1,57 @@
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+#include <Arduino.h>
+
+/**
+ * JSON Writer - builds JSON into a caller-provided fixed buffer
+ * No heap allocations; output is truncated (and flagged) instead of growing
+ */
+class JsonWriter {
+    private:
+        static const uint8_t MAX_DEPTH = 8;
+
+        char* buffer;
+        size_t capacity;
+        size_t length = 0;
+        bool overflow = false;
+        uint8_t depth = 0;
+        uint8_t hasMembers = 0; // Bit per nesting level: a comma is needed before the next member
+
+        void append(char c);
+        void append(const char* text);
+        void appendEscaped(const char* text);
+        void separator();
+        void key(const char* name);
+
+    public:
+        JsonWriter(char* buffer, size_t capacity);
+
+        void reset();
+
+        JsonWriter& beginObject();
+        JsonWriter& beginObject(const char* name);
+        JsonWriter& endObject();
+        JsonWriter& beginArray();
+        JsonWriter& beginArray(const char* name);
+        JsonWriter& endArray();
+
+        JsonWriter& field(const char* name, const char* value);
+        JsonWriter& field(const char* name, bool value);
+        JsonWriter& field(const char* name, long value);
+        JsonWriter& field(const char* name, unsigned long value);
+        JsonWriter& field(const char* name, int value) { return field(name, (long)value); }
+        JsonWriter& field(const char* name, unsigned int value) { return field(name, (unsigned long)value); }
+
+        // Array elements
+        JsonWriter& value(long value);
+        JsonWriter& value(unsigned long value);
+        JsonWriter& value(int value) { return this->value((long)value); }
+        JsonWriter& value(unsigned int value) { return this->value((unsigned long)value); }
+
+        const char* c_str() const { return buffer; }
+        size_t size() const { return length; }
+        bool overflowed() const { return overflow; }
+};
+
+#endif // JSON_WRITER_HPP
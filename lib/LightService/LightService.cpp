@@ -1,39 +1,280 @@
 #include "LightService.hpp"
+#include "Profiler.hpp"
+#include <limits.h>
+#include <math.h>
 
-LightService::LightService() 
-    : currentBrightness(MIN_BRIGHTNESS), newBrightness(MIN_BRIGHTNESS) {
+#ifndef NATIVE
+#include "FastLedDriver.hpp"
+#endif
+
+// Optional measured pixel positions, see include/LedLayout.h.example
+#ifdef __has_include
+  #if __has_include("LedLayout.h")
+    #include "LedLayout.h"
+  #endif
+#endif
+
+#ifdef LED_LAYOUT
+static const PixelPosition ledLayout[] = {LED_LAYOUT};
+static_assert(sizeof(ledLayout) / sizeof(ledLayout[0]) == NUM_LEDS, "LED_LAYOUT needs one entry per LED");
+#endif
+
+// Ordered dither over 8 frames: frame i rounds the brightness up when its
+// low byte exceeds the threshold, so the average keeps 3 more bits
+static const uint8_t ditherThresholds[8] = {16, 144, 80, 208, 48, 176, 112, 240};
+
+// While dithering or crossfading the strip is refreshed at this rate even without new writes
+static const unsigned long REFRESH_INTERVAL = 1000 / TARGET_FPS;
+
+// 8-bit brightness in 8.8 fixed point, only 255 fills the low byte so
+// setBrightness() never dithers
+static uint16_t toBrightness16(uint8_t brightness) {
+    return brightness == 255 ? 0xFFFF : brightness << 8;
 }
 
-void LightService::setup() {
-    FastLED.addLeds<LED_TYPE, DATA_PIN>(leds, NUM_LEDS);
-    FastLED.setBrightness(currentBrightness);
-    FastLED.clear();
+// Dark strip current, the power budget covers it too
+static const uint32_t IDLE_DRAW = (uint32_t)LED_IDLE_MA * NUM_LEDS;
+
+// Channel sum of one color, the power estimate is linear in it
+static uint16_t channelSum(const CRGB& color) {
+    return color.r + color.g + color.b;
+}
+
+LightService::LightService(LedDriver* driver) 
+    : driver(driver), brightness(toBrightness16(MIN_BRIGHTNESS)) {
+#ifndef NATIVE
+    if (!this->driver) {
+        static FastLedDriver defaultDriver;
+        this->driver = &defaultDriver;
+    }
+#endif
+    buildPixelMap();
+    buildGeometry();
+}
+
+void LightService::buildPixelMap() {
+    // Strips are consecutive in the output buffer, reversed ones count down
+    for (uint16_t strip = 0; strip < LED_STRIP_COUNT; strip++) {
+        bool reversed = (LED_STRIP_REVERSED >> strip) & 1;
+        uint16_t first = strip * LED_STRIP_LENGTH;
+        for (uint16_t offset = 0; offset < LED_STRIP_LENGTH; offset++) {
+            pixelMap[first + offset] = first + (reversed ? LED_STRIP_LENGTH - 1 - offset : offset);
+        }
+    }
+}
+
+static int32_t squaredLength(const PixelPosition& p) {
+    return (int32_t)p.x * p.x + (int32_t)p.y * p.y + (int32_t)p.z * p.z;
+}
+
+void LightService::buildGeometry() {
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+#ifdef LED_LAYOUT
+        geometry[i] = ledLayout[i];
+#else
+        // Without a layout the pixels form a line along x, one face per strip
+        int8_t x = ((2 * (int32_t)i + 1 - NUM_LEDS) * 127) / NUM_LEDS;
+        geometry[i] = {x, 0, 0, (uint8_t)(i / LED_STRIP_LENGTH)};
+#endif
+        if (geometry[i].face >= faceCount) {
+            faceCount = geometry[i].face + 1;
+        }
+    }
     
-    // Set initial white color
-    for (int i = 0; i < NUM_LEDS; i++) {
-        leds[i] = CRGB::White;
+    // Distances are normalized to the farthest pixel so effects scale with the layout
+    int32_t farthest = 0;
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        farthest = max(farthest, squaredLength(geometry[i]));
+    }
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        centerDistance[i] = farthest > 0 ? (uint8_t)(sqrtf((float)squaredLength(geometry[i]) / farthest) * 255 + 0.5f) : 0;
+    }
+}
+
+void LightService::setup() {
+    // Modes call setup() on every activation, only register the strip once
+    if (!initialized) {
+        // Brightness is applied to the output buffer, the driver runs at full scale
+        driver->begin(frame, NUM_LEDS);
+        driver->setBrightness(255);
+        initialized = true;
     }
     
-    FastLED.show();
+    // Set initial white color
+    setColor(CRGB::White);
     Serial.println("[INFO] LightService initialized");
 }
 
 void LightService::setBrightness(uint8_t brightness) {
-    currentBrightness = brightness;
-    FastLED.setBrightness(currentBrightness);
-    FastLED.show();
+    setBrightness16(toBrightness16(brightness));
+}
+
+void LightService::setBrightness16(uint16_t brightness) {
+    if (brightness == this->brightness) {
+        return;
+    }
+    this->brightness = brightness;
+    markDirty();
+}
+
+void LightService::setBrightnessLimit(uint8_t limit) {
+    if (limit == brightnessLimit) {
+        return;
+    }
+    brightnessLimit = limit;
+    markDirty();
 }
 
 void LightService::setColor(const CRGB& color) {
     for (int i = 0; i < NUM_LEDS; i++) {
         leds[i] = color;
     }
-    FastLED.show();
+    canvasSum = (uint32_t)channelSum(color) * NUM_LEDS;
+    powerLimitValid = false;
+    markDirty();
 }
 
-void LightService::setLedColor(uint8_t index, const CRGB& color) {
+void LightService::setLedColor(uint16_t index, const CRGB& color) {
     if (index < NUM_LEDS) {
+        canvasSum += channelSum(color) - channelSum(leds[index]);
         leds[index] = color;
-        FastLED.show();
+        powerLimitValid = false;
+        markDirty();
+    }
+}
+
+void LightService::show() {
+    markDirty();
+}
+
+void LightService::clear() {
+    for (int i = 0; i < NUM_LEDS; i++) {
+        leds[i] = CRGB::Black;
+    }
+    canvasSum = 0;
+    powerLimitValid = false;
+    markDirty();
+}
+
+void LightService::beginFrame() {
+    frameActive = true;
+}
+
+void LightService::startTransition(uint16_t durationMs) {
+    if (!initialized || durationMs == 0) {
+        return;
+    }
+    
+    // Start from the frame on the strip, also when a crossfade is still running
+    memcpy(fromFrame, frame, sizeof(frame));
+    transitionStart = millis();
+    transitionDuration = durationMs;
+}
+
+bool LightService::needsRefresh() const {
+    if (!refreshEnabled) {
+        return false;
+    }
+#if LED_TEMPORAL_DITHER
+    // Only a fraction below full scale alternates between frames, 0xFFFF
+    // (setBrightness(255)) renders the same frame every time
+    if ((brightness & 0xFF) != 0 && (brightness >> 8) < 255) {
+        return true;
+    }
+#endif
+    return transitionDuration > 0;
+}
+
+uint16_t LightService::applyPowerLimit(uint16_t scale) {
+    // Current = idle + canvasSum * scale / 256 * LED_MA_PER_CHANNEL / 255, the
+    // highest scale within the budget only changes when the canvas does
+    uint32_t fullDraw = (canvasSum * LED_MA_PER_CHANNEL) / 255; // mA at scale 256
+    if (!powerLimitValid) {
+        powerLimit = 256;
+#if LED_POWER_BUDGET_MA > 0
+        uint32_t budget = LED_POWER_BUDGET_MA > IDLE_DRAW ? LED_POWER_BUDGET_MA - IDLE_DRAW : 0;
+        if (fullDraw > budget) {
+            powerLimit = (budget * 256) / fullDraw;
+        }
+#endif
+        powerLimitValid = true;
+    }
+    
+    scale = min(scale, powerLimit);
+    powerDraw = IDLE_DRAW + ((fullDraw * scale) >> 8);
+    return scale;
+}
+
+unsigned long LightService::timeUntilRefresh() const {
+    if (!needsRefresh()) {
+        return ULONG_MAX;
+    }
+    unsigned long elapsed = millis() - lastShow;
+    return elapsed >= REFRESH_INTERVAL ? 0 : REFRESH_INTERVAL - elapsed;
+}
+
+void LightService::renderOutput(unsigned long now) {
+    // Brightness of this frame
+    uint16_t scale = brightness >> 8;
+#if LED_TEMPORAL_DITHER
+    if ((brightness & 0xFF) > ditherThresholds[ditherStep] && scale < 255) {
+        scale++;
+    }
+    ditherStep = (ditherStep + 1) % 8;
+#endif
+    scale++; // (value * 256) >> 8 keeps full scale at 255
+    scale = (scale * (brightnessLimit + 1)) >> 8;
+    scale = applyPowerLimit(scale);
+    
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        CRGB& out = frame[pixelMap[i]];
+        for (uint8_t c = 0; c < 3; c++) {
+            out.raw[c] = (leds[i].raw[c] * scale) >> 8;
+        }
+    }
+    
+    if (transitionDuration == 0) {
+        return;
+    }
+    
+    unsigned long elapsed = now - transitionStart;
+    if (elapsed >= transitionDuration) {
+        transitionDuration = 0;
+        return;
+    }
+    
+    // Blend weight of the new frame, 0..255
+    uint16_t weight = (elapsed * 256) / transitionDuration;
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        for (uint8_t c = 0; c < 3; c++) {
+            frame[i].raw[c] = (fromFrame[i].raw[c] * (256 - weight) + frame[i].raw[c] * weight) >> 8;
+        }
+    }
+}
+
+bool LightService::commitFrame() {
+    frameActive = false;
+    
+    unsigned long now = millis();
+    if (!dirty && !(needsRefresh() && now - lastShow >= REFRESH_INTERVAL)) {
+        return false;
+    }
+    
+    renderOutput(now);
+    {
+        PROFILE_SCOPE(PROFILE_SHOW);
+        driver->show();
+    }
+    lastShow = now;
+    dirty = false;
+    return true;
+}
+
+void LightService::markDirty() {
+    dirty = true;
+    
+    // Outside of a frame there is nobody to commit, push the change right away
+    if (!frameActive) {
+        commitFrame();
     }
 }
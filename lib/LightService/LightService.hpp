@@ -5,27 +5,92 @@
 #include <FastLED.h>
 
 #include "Config.h"
+#include "LedDriver.hpp"
+
+// Where a pixel sits on the box, each axis -127..127 around the center
+struct PixelPosition {
+    int8_t x;
+    int8_t y;
+    int8_t z;     // Up
+    uint8_t face; // Cube face (or strip) the pixel belongs to
+};
 
 class LightService {
     private:
-        CRGB leds[NUM_LEDS];
-        const uint8_t numLeds = NUM_LEDS;
+        CRGB leds[NUM_LEDS];      // Canvas the active mode draws into
+        CRGB frame[NUM_LEDS];     // Scaled and blended output, pushed by the driver
+        CRGB fromFrame[NUM_LEDS]; // Last frame of the previous mode while crossfading
+        LedDriver* driver;
+        uint16_t pixelMap[NUM_LEDS]; // Logical pixel -> position in the output buffer
+        PixelPosition geometry[NUM_LEDS];
+        uint8_t centerDistance[NUM_LEDS]; // 0 = center, 255 = farthest pixel
+        uint8_t faceCount = 1;
+
+        uint16_t brightness;      // 8.8 fixed point, the low byte is dithered over frames
+        uint8_t ditherStep = 0;
+        uint8_t brightnessLimit = MAX_BRIGHTNESS; // Scales every mode's output, e.g. set remotely
+
+        // Sum of all canvas channels, kept up to date by the setters
+        uint32_t canvasSum = 0;
+        uint16_t powerLimit = 256;     // Highest output scale within LED_POWER_BUDGET_MA
+        bool powerLimitValid = false;  // Cleared when canvasSum changes
+        uint16_t powerDraw = 0;        // Estimate for the last shown frame in mA
+
+        unsigned long transitionStart = 0;
+        uint16_t transitionDuration = 0; // 0 = no crossfade running
+        unsigned long lastShow = 0;
+        bool refreshEnabled = true;      // Off while idle, only new writes are shown
 
-        uint8_t currentBrightness;
-        uint8_t newBrightness;
+        bool initialized = false;
+        bool frameActive = false; // Between beginFrame() and commitFrame()
+        bool dirty = false;       // Buffer changed since last show()
+
+        void markDirty();
+        void buildPixelMap();
+        void buildGeometry();
+        bool needsRefresh() const;
+        uint16_t applyPowerLimit(uint16_t scale);
+        void renderOutput(unsigned long now);
 
     public:
-        LightService();
+        // Uses the FastLED driver on the board when driver is nullptr
+        LightService(LedDriver* driver = nullptr);
 
         void setBrightness(uint8_t brightness);
+        void setBrightness16(uint16_t brightness);
         void setColor(const CRGB& color);
-        void setLedColor(uint8_t index, const CRGB& color);
+        void setLedColor(uint16_t index, const CRGB& color);
         
-        uint8_t getBrightness() const { return currentBrightness; }
-        void show() { FastLED.show(); }
-        void clear() { FastLED.clear(); }
+        uint8_t getBrightness() const { return brightness >> 8; }
+        uint16_t getBrightness16() const { return brightness; }
+        void setBrightnessLimit(uint8_t limit);
+        uint8_t getBrightnessLimit() const { return brightnessLimit; }
+        void show();
+        void clear();
+
+        // Frame handling - writes inside a frame are only pushed to the strip on commitFrame()
+        void beginFrame();
+        bool commitFrame();
+        bool isDirty() const { return dirty; }
+        // Time until commitFrame() has to refresh on its own (dithering, crossfade)
+        unsigned long timeUntilRefresh() const;
+        // Suspends the dither and crossfade refresh, e.g. in the idle power mode
+        void setRefreshEnabled(bool enabled) { refreshEnabled = enabled; }
+
+        // Crossfade from what is on the strip now to the following frames
+        void startTransition(uint16_t durationMs);
+        bool isTransitioning() const { return transitionDuration > 0; }
+
+        // Estimated LED current of the last frame, and whether it was dimmed to fit the budget
+        uint16_t getPowerDraw() const { return powerDraw; }
+        bool isPowerLimited() const { return powerLimit < 256; }
+
+        // Pixel geometry from LedLayout.h (or a straight line), built once
+        const PixelPosition& getPosition(uint16_t index) const { return geometry[index]; }
+        uint8_t getCenterDistance(uint16_t index) const { return centerDistance[index]; }
+        uint8_t getFaceCount() const { return faceCount; }
 
         void setup();
 };
 
-#endif // LIGHT_SERVICE_HPP
\ No newline at end of file
+#endif // LIGHT_SERVICE_HPP
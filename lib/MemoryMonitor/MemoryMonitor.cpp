@@ -0,0 +1,60 @@
+#include "MemoryMonitor.hpp"
+
+uint32_t MemoryMonitor::minFreeHeap = 0;
+#ifdef ESP32
+TaskHandle_t MemoryMonitor::loopTask = nullptr;
+TaskHandle_t MemoryMonitor::ioTask = nullptr;
+#endif
+
+void MemoryMonitor::setup() {
+#ifdef ESP32
+    loopTask = xTaskGetCurrentTaskHandle();
+#endif
+    minFreeHeap = ESP.getFreeHeap();
+}
+
+void MemoryMonitor::sample() {
+#ifndef ESP32
+    uint32_t freeHeap = ESP.getFreeHeap();
+    if (freeHeap < minFreeHeap) {
+        minFreeHeap = freeHeap;
+    }
+#endif
+}
+
+void MemoryMonitor::read(MemoryStats& target) {
+    sample();
+    target.freeHeap = ESP.getFreeHeap();
+
+#ifdef ESP32
+    target.minFreeHeap = ESP.getMinFreeHeap();
+    target.largestBlock = ESP.getMaxAllocHeap();
+    target.fragmentation = target.freeHeap > 0
+        ? 100 - (uint8_t)((uint64_t)target.largestBlock * 100 / target.freeHeap)
+        : 0;
+    // ESP-IDF reports the high-water mark in bytes
+    target.loopStackFree = loopTask ? uxTaskGetStackHighWaterMark(loopTask) : 0;
+    target.ioStackFree = ioTask ? uxTaskGetStackHighWaterMark(ioTask) : 0;
+#else
+    target.minFreeHeap = minFreeHeap;
+    target.largestBlock = ESP.getMaxFreeBlockSize();
+    target.fragmentation = ESP.getHeapFragmentation();
+    // Lowest free cont stack, measured against the stack painting done at boot
+    target.loopStackFree = ESP.getFreeContStack();
+    target.ioStackFree = 0;
+#endif
+}
+
+void MemoryMonitor::print(Print& out) {
+    MemoryStats stats;
+    read(stats);
+
+    out.printf("[MEM] Free heap:       %u bytes\n", (unsigned)stats.freeHeap);
+    out.printf("[MEM] Min free heap:   %u bytes\n", (unsigned)stats.minFreeHeap);
+    out.printf("[MEM] Largest block:   %u bytes\n", (unsigned)stats.largestBlock);
+    out.printf("[MEM] Fragmentation:   %u %%\n", (unsigned)stats.fragmentation);
+    out.printf("[MEM] loop() stack:    %u bytes never used\n", (unsigned)stats.loopStackFree);
+#if ENABLE_DUAL_CORE
+    out.printf("[MEM] I/O task stack:  %u bytes never used\n", (unsigned)stats.ioStackFree);
+#endif
+}
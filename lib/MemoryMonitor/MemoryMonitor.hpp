@@ -0,0 +1,42 @@
+#ifndef MEMORY_MONITOR_HPP
+#define MEMORY_MONITOR_HPP
+
+#include <Arduino.h>
+#include "Config.h"
+
+struct MemoryStats {
+    uint32_t freeHeap;      // Free heap right now
+    uint32_t minFreeHeap;   // Lowest free heap since boot
+    uint32_t largestBlock;  // Largest block a single malloc() can get
+    uint8_t fragmentation;  // 0 = all free heap in one block, 100 = fully fragmented
+    uint32_t loopStackFree; // Stack of loop() never touched since boot (bytes)
+    uint32_t ioStackFree;   // Same for the I/O task (ENABLE_DUAL_CORE only, else 0)
+};
+
+/**
+ * MemoryMonitor - heap and stack watermarks for the heartbeat
+ * The ESP32 heap tracks its own minimum, on the ESP8266 sample() keeps
+ * the lowest value seen at the end of each loop() iteration.
+ */
+class MemoryMonitor {
+    private:
+        static uint32_t minFreeHeap;
+#ifdef ESP32
+        static TaskHandle_t loopTask;
+        static TaskHandle_t ioTask;
+#endif
+
+    public:
+        // Call from setup(), in the task that runs loop()
+        static void setup();
+        static void sample();
+
+#ifdef ESP32
+        static void setIoTask(TaskHandle_t task) { ioTask = task; }
+#endif
+
+        static void read(MemoryStats& target);
+        static void print(Print& out);
+};
+
+#endif // MEMORY_MONITOR_HPP
@@ -1,5 +1,46 @@
 #include "MqttService.hpp"
 
+#if ENABLE_WIFI
+#include <LittleFS.h>
+
+MqttService* MqttService::instance = nullptr;
+
+static const char* WIFI_CACHE_FILE = "/wifi.bin";
+static const uint16_t WIFI_CACHE_MAGIC = 0x57C1;
+static const uint8_t WIFI_CACHE_VERSION = 1;
+
+// Command names below <base topic>/cmd/ and the accepted value range
+struct CommandSpec {
+    const char* name;
+    MqttCommand command;
+    long minValue;
+    long maxValue;
+    bool binary; // Payload goes to the upload handler instead of being parsed
+};
+
+static const CommandSpec commandSpecs[] = {
+    {"mode",       COMMAND_MODE,       0, 254, false},
+    {"donation",   COMMAND_DONATION,   0, 0,   false},
+    {"volume",     COMMAND_VOLUME,     0, 30,  false},
+    {"brightness", COMMAND_BRIGHTNESS, 0, 255, false},
+    {"animation",  COMMAND_ANIMATION,  0, 0,   true},
+    {"update",     COMMAND_UPDATE,     0, 0,   true},
+};
+
+#if ENABLE_ANIMATION_MODE && ANIMATION_MAX_SIZE + MQTT_TOPIC_LENGTH + 8 > MQTT_BUFFER_SIZE
+#error "MQTT_BUFFER_SIZE too small for an ANIMATION_MAX_SIZE upload"
+#endif
+
+// Binary telemetry records, see docs/MQTT.md and scripts/decode_telemetry.py
+static const uint8_t TELEMETRY_VERSION = 1;
+static const uint8_t RECORD_STATUS = 1;
+static const uint8_t RECORD_HEARTBEAT = 2;
+static const uint8_t RECORD_WIFI_CONNECTED = 0x01;
+static const uint8_t RECORD_MQTT_CONNECTED = 0x02;
+static const uint8_t RECORD_IO_STACK = 0x04;
+static const uint8_t RECORD_WIFI_FAST = 0x08;
+#endif
+
 MqttService::MqttService(const char* ssid, const char* password, 
                          const char* server, int port,
                          const char* clientId, const char* user, const char* pass)
@@ -8,18 +49,23 @@ MqttService::MqttService(const char* ssid, const char* password,
       mqttServer(server), mqttPort(port), mqttClientId(clientId),
       mqttUser(user), mqttPassword(pass),
       mqttClient(wifiClient),
-      wifiConnected(false), mqttConnected(false),
-      lastReconnectAttempt(0), lastHeartbeat(0) {
+      connectionState(STATE_WIFI_WAIT),
+      wifiConnected(false), mqttConnected(false), everConnected(false),
+      stateSince(0), retryDelay(RECONNECT_BACKOFF_MIN), lastHeartbeat(0), lastMetrics(0) {
     
     // Set default base topic
-    baseTopic = String("donation-box/") + String(clientId);
-    donationTopic = baseTopic + "/donations";
-    logTopic = baseTopic + "/logs";
-    statusTopic = baseTopic + "/status";
-    modeTopic = baseTopic + "/mode";
+    char defaultTopic[MQTT_TOPIC_LENGTH];
+    snprintf(defaultTopic, sizeof(defaultTopic), "donation-box/%s", clientId);
+    setBaseTopic(defaultTopic);
     
     // Configure MQTT client
     mqttClient.setServer(mqttServer, mqttPort);
+    mqttClient.setKeepAlive(MQTT_KEEPALIVE);
+    mqttClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT);
+    
+    // There is one MqttService, the static callback forwards to it
+    instance = this;
+    mqttClient.setCallback(handleMessage);
 #else
     {
     // Dummy mode - WiFi/MQTT disabled
@@ -32,19 +78,14 @@ void MqttService::setup() {
 #if ENABLE_WIFI
     Serial.println("[MQTT] MqttService setup started");
     
-    // Initialize WiFi
-    connectWiFi();
+    // Restore events queued before a reboot and make room for replay batches
+    eventQueue.setup();
+    mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
     
-    if (wifiConnected) {
-        // Initialize MQTT connection
-        connectMQTT();
-        
-        if (mqttConnected) {
-            // Send startup message
-            systemStatus("online");
-            logInfo("Donation box system started");
-        }
-    }
+    // Kick off WiFi, the connection completes in the background via loop()
+    WiFi.mode(WIFI_STA);
+    loadWiFiCache();
+    startWiFi();
     
     Serial.println("[MQTT] MqttService setup complete");
 #else
@@ -56,39 +97,84 @@ void MqttService::setup() {
 void MqttService::loop() {
 #if ENABLE_WIFI
     unsigned long currentTime = millis();
+    bool wifiUp = WiFi.status() == WL_CONNECTED;
     
-    // Maintain WiFi connection
-    if (WiFi.status() != WL_CONNECTED) {
+    // Losing WiFi drops back to the start from any connected state
+    if (!wifiUp && wifiConnected) {
+        Serial.println("[MQTT] WiFi connection lost");
         wifiConnected = false;
-        if (currentTime - lastReconnectAttempt >= RECONNECT_INTERVAL) {
-            connectWiFi();
-            lastReconnectAttempt = currentTime;
-        }
-    } else {
-        wifiConnected = true;
+        mqttConnected = false;
+        brokerResolved = false; // The next network may resolve it differently
+        retryDelay = 0;
+        scheduleRetry(STATE_WIFI_WAIT);
     }
     
-    // Maintain MQTT connection
-    if (wifiConnected) {
-        if (!mqttClient.connected()) {
-            mqttConnected = false;
-            if (currentTime - lastReconnectAttempt >= RECONNECT_INTERVAL) {
-                if (reconnect()) {
-                    lastReconnectAttempt = 0;
+    switch (connectionState) {
+        case STATE_WIFI_WAIT:
+            if (wifiUp) {
+                // The WiFi stack reconnected on its own
+                wifiConnected = true;
+                setState(STATE_MQTT_WAIT);
+            } else if (currentTime - stateSince >= retryDelay) {
+                startWiFi();
+            }
+            break;
+            
+        case STATE_WIFI_CONNECTING:
+            if (wifiUp) {
+                wifiJoined();
+                // Try the broker right away
+                retryDelay = 0;
+                setState(STATE_MQTT_WAIT);
+            } else if (fastAttempt && currentTime - stateSince >= WIFI_FAST_TIMEOUT) {
+                // Access point moved or gone, the same attempt goes on with a scan
+                Serial.println("[MQTT] Fast connect failed, scanning");
+                wifiCacheValid = false;
+                scanWiFi();
+            } else if (currentTime - stateSince >= WIFI_TIMEOUT) {
+                Serial.println("[MQTT] WiFi connection failed");
+                scheduleRetry(STATE_WIFI_WAIT);
+            }
+            break;
+            
+        case STATE_MQTT_WAIT:
+            if (currentTime - stateSince >= retryDelay) {
+                if (connectBroker()) {
+                    retryDelay = RECONNECT_BACKOFF_MIN;
+                    setState(STATE_MQTT_CONNECTED);
                 } else {
-                    lastReconnectAttempt = currentTime;
+                    scheduleRetry(STATE_MQTT_WAIT);
                 }
             }
-        } else {
-            mqttConnected = true;
+            break;
+            
+        case STATE_MQTT_CONNECTED:
+            if (!mqttClient.connected()) {
+                Serial.println("[MQTT] MQTT connection lost");
+                mqttConnected = false;
+                retryDelay = 0;
+                scheduleRetry(STATE_MQTT_WAIT);
+                break;
+            }
+            
             mqttClient.loop(); // Process MQTT messages
-        }
-        
-        // Send heartbeat
-        if (mqttConnected && currentTime - lastHeartbeat >= HEARTBEAT_INTERVAL) {
-            publishHeartbeat();
-            lastHeartbeat = currentTime;
-        }
+            
+            // Replay events queued while offline, one batch per loop
+            flushEventQueue();
+            
+            // Send heartbeat
+            if (currentTime - lastHeartbeat >= HEARTBEAT_INTERVAL) {
+                publishHeartbeat();
+                lastHeartbeat = currentTime;
+            }
+            
+#if ENABLE_PROFILING
+            if (currentTime - lastMetrics >= METRICS_INTERVAL) {
+                publishMetrics();
+                lastMetrics = currentTime;
+            }
+#endif
+            break;
     }
 #else
     // Dummy mode - no actual network operations
@@ -96,129 +182,143 @@ void MqttService::loop() {
 #endif
 }
 
-void MqttService::donation(const String& mode, int amount) {
+void MqttService::donation(const char* mode, int amount) {
 #if ENABLE_WIFI
-    if (!mqttConnected) {
-        Serial.println("[MQTT] Cannot send donation - not connected");
+    // Publish directly only if nothing older is still waiting, to keep the order
+    if (mqttConnected && eventQueue.isEmpty() && publishDonation(mode, amount)) {
         return;
     }
     
-    String payload = "{";
-    payload += "\"timestamp\":\"" + formatTimestamp() + "\",";
-    payload += "\"mode\":\"" + mode + "\",";
-    payload += "\"amount\":" + String(amount) + ",";
-    payload += "\"event\":\"donation\"";
-    payload += "}";
-    
-    if (mqttClient.publish(donationTopic.c_str(), payload.c_str())) {
-        Serial.println("[MQTT] Donation published: " + mode);
-    } else {
-        Serial.println("[MQTT] Failed to publish donation");
-    }
+    eventQueue.pushDonation(mode, amount);
+    Serial.print("[MQTT] Donation queued - ");
+    Serial.print(eventQueue.size());
+    Serial.println(" events pending");
 #else
-    Serial.println("[MQTT] Standalone mode - donation logged locally: " + mode);
+    Serial.print("[MQTT] Standalone mode - donation logged locally: ");
+    Serial.println(mode);
 #endif
 }
 
-void MqttService::logInfo(const String& message) {
+void MqttService::logInfo(const char* message) {
 #if ENABLE_WIFI
     if (!mqttConnected) {
         return; // Fail silently for logs
     }
     
-    String payload = "{";
-    payload += "\"timestamp\":\"" + formatTimestamp() + "\",";
-    payload += "\"level\":\"INFO\",";
-    payload += "\"message\":\"" + message + "\"";
-    payload += "}";
-    
-    mqttClient.publish(logTopic.c_str(), payload.c_str());
+    publishLog("INFO", message);
 #else
     // In standalone mode, just log to serial
-    Serial.println("[INFO] " + message);
+    Serial.print("[INFO] ");
+    Serial.println(message);
 #endif
 }
 
-void MqttService::logWarning(const String& message) {
+void MqttService::logWarning(const char* message) {
 #if ENABLE_WIFI
     if (!mqttConnected) {
         return;
     }
     
-    String payload = "{";
-    payload += "\"timestamp\":\"" + formatTimestamp() + "\",";
-    payload += "\"level\":\"WARNING\",";
-    payload += "\"message\":\"" + message + "\"";
-    payload += "}";
-    
-    mqttClient.publish(logTopic.c_str(), payload.c_str());
-    Serial.println("[MQTT] Warning logged: " + message);
+    publishLog("WARNING", message);
+    Serial.print("[MQTT] Warning logged: ");
+    Serial.println(message);
 #else
-    Serial.println("[WARNING] " + message);
+    Serial.print("[WARNING] ");
+    Serial.println(message);
 #endif
 }
 
-void MqttService::logError(const String& message) {
+void MqttService::logError(const char* message) {
 #if ENABLE_WIFI
     if (!mqttConnected) {
         return;
     }
     
-    String payload = "{";
-    payload += "\"timestamp\":\"" + formatTimestamp() + "\",";
-    payload += "\"level\":\"ERROR\",";
-    payload += "\"message\":\"" + message + "\"";
-    payload += "}";
+    publishLog("ERROR", message);
+    Serial.print("[MQTT] Error logged: ");
+    Serial.println(message);
+#else
+    Serial.print("[ERROR] ");
+    Serial.println(message);
+#endif
+}
+
+void MqttService::modeChanged(const char* fromMode, const char* toMode) {
+#if ENABLE_WIFI
+    if (mqttConnected && eventQueue.isEmpty() && publishModeChange(fromMode, toMode)) {
+        return;
+    }
     
-    mqttClient.publish(logTopic.c_str(), payload.c_str());
-    Serial.println("[MQTT] Error logged: " + message);
+    eventQueue.pushModeChange(fromMode, toMode);
 #else
-    Serial.println("[ERROR] " + message);
+    Serial.print("[MQTT] Standalone mode - mode changed: ");
+    Serial.print(fromMode);
+    Serial.print(" -> ");
+    Serial.println(toMode);
 #endif
 }
 
-void MqttService::modeChanged(const String& fromMode, const String& toMode) {
+void MqttService::systemStatus(const char* status) {
 #if ENABLE_WIFI
     if (!mqttConnected) {
-        Serial.println("[MQTT] Cannot send mode change - not connected");
         return;
     }
     
-    String payload = "{";
-    payload += "\"timestamp\":\"" + formatTimestamp() + "\",";
-    payload += "\"from_mode\":\"" + fromMode + "\",";
-    payload += "\"to_mode\":\"" + toMode + "\",";
-    payload += "\"event\":\"mode_change\"";
-    payload += "}";
-    
-    if (mqttClient.publish(modeTopic.c_str(), payload.c_str())) {
-        Serial.println("[MQTT] Mode change published: " + fromMode + " -> " + toMode);
-    } else {
-        Serial.println("[MQTT] Failed to publish mode change");
-    }
+#if MQTT_BINARY_TELEMETRY
+    BinaryWriter record((uint8_t*)payloadBuffer, sizeof(payloadBuffer));
+    writeRecordHeader(record, RECORD_STATUS);
+    record.str(status)
+          .u16(wifiConnectTime);
+    mqttClient.publish(statusTopic, record.data(), record.size());
 #else
-    Serial.println("[MQTT] Standalone mode - mode changed: " + fromMode + " -> " + toMode);
+    char timestamp[TIMESTAMP_LENGTH];
+    formatTimestamp(timestamp, sizeof(timestamp), millis());
+    
+    JsonWriter json(payloadBuffer, sizeof(payloadBuffer));
+    json.beginObject()
+        .field("timestamp", timestamp)
+        .field("status", status)
+        .field("wifi_connected", wifiConnected)
+        .field("mqtt_connected", mqttConnected)
+        .field("wifi_connect_ms", (unsigned int)wifiConnectTime)
+        .field("wifi_fast", wifiConnectFast)
+        .field("uptime", millis());
+    writeMemory(json);
+    json.endObject();
+    
+    mqttClient.publish(statusTopic, json.c_str());
+#endif
+#else
+    Serial.print("[MQTT] Standalone mode - system status: ");
+    Serial.println(status);
 #endif
 }
 
-void MqttService::systemStatus(const String& status) {
+bool MqttService::donationStats(const DonationSummary& stats) {
 #if ENABLE_WIFI
     if (!mqttConnected) {
-        return;
+        return false;
     }
     
-    String payload = "{";
-    payload += "\"timestamp\":\"" + formatTimestamp() + "\",";
-    payload += "\"status\":\"" + status + "\",";
-    payload += "\"wifi_connected\":" + String(wifiConnected ? "true" : "false") + ",";
-    payload += "\"mqtt_connected\":" + String(mqttConnected ? "true" : "false") + ",";
-    payload += "\"free_heap\":" + String(ESP.getFreeHeap()) + ",";
-    payload += "\"uptime\":" + String(millis());
-    payload += "}";
+    JsonWriter json(payloadBuffer, sizeof(payloadBuffer));
+    json.beginObject()
+        .field("total", (unsigned long)stats.total)
+        .field("since_boot", (unsigned long)stats.sinceBoot)
+        .field("last_hour", (unsigned int)stats.lastHour)
+        .field("peak_hour", (unsigned int)stats.peakHour)
+        .field("peak_minute", (unsigned int)stats.peakMinute)
+        .field("uptime", millis())
+        .beginArray("per_mode");
+    for (uint8_t i = 0; i < DONATION_STATS_MODES; i++) {
+        json.value((unsigned long)stats.perMode[i]);
+    }
+    json.endArray().endObject();
     
-    mqttClient.publish(statusTopic.c_str(), payload.c_str());
+    // Retained, so a dashboard gets the current numbers as soon as it subscribes
+    return mqttClient.publish(statsTopic, json.c_str(), true);
 #else
-    Serial.println("[MQTT] Standalone mode - system status: " + status);
+    (void)stats;
+    return false;
 #endif
 }
 
@@ -230,6 +330,14 @@ bool MqttService::isConnected() const {
 #endif
 }
 
+uint8_t MqttService::getQueuedEvents() const {
+#if ENABLE_WIFI
+    return eventQueue.size();
+#else
+    return 0;
+#endif
+}
+
 bool MqttService::isWiFiConnected() const {
 #if ENABLE_WIFI
     return wifiConnected;
@@ -252,62 +360,226 @@ String MqttService::getConnectionStatus() const {
 #endif
 }
 
-void MqttService::setBaseTopic(const String& topic) {
+void MqttService::setBaseTopic(const char* topic) {
 #if ENABLE_WIFI
-    baseTopic = topic;
-    donationTopic = baseTopic + "/donations";
-    logTopic = baseTopic + "/logs";
-    statusTopic = baseTopic + "/status";
-    modeTopic = baseTopic + "/mode";
+    snprintf(baseTopic, sizeof(baseTopic), "%s", topic);
+    buildTopic(donationTopic, "donations");
+    buildTopic(logTopic, "logs");
+    buildTopic(statusTopic, "status");
+    buildTopic(modeTopic, "mode");
+    buildTopic(backlogTopic, "backlog");
+    buildTopic(heartbeatTopic, "heartbeat");
+    buildTopic(metricsTopic, "metrics");
+    buildTopic(statsTopic, "stats");
+    buildTopic(commandTopic, "cmd/+");
 #else
     // Do nothing in standalone mode
+    (void)topic;
+#endif
+}
+
+void MqttService::setCommandHandler(MqttCommandHandler handler) {
+#if ENABLE_WIFI
+    commandHandler = handler;
+#else
+    (void)handler;
+#endif
+}
+
+void MqttService::setUploadHandler(MqttUploadHandler handler) {
+#if ENABLE_WIFI
+    uploadHandler = handler;
+#else
+    (void)handler;
 #endif
 }
 
 #if ENABLE_WIFI
 // Private methods (only available when WiFi is enabled)
 
-void MqttService::connectWiFi() {
-    if (WiFi.status() == WL_CONNECTED) {
-        wifiConnected = true;
+void MqttService::setState(ConnectionState state) {
+    connectionState = state;
+    stateSince = millis();
+}
+
+void MqttService::scheduleRetry(ConnectionState state) {
+    // Exponential backoff: 0 -> MIN -> 2*MIN -> ... -> MAX
+    if (retryDelay < RECONNECT_BACKOFF_MIN) {
+        retryDelay = RECONNECT_BACKOFF_MIN;
+    } else {
+        retryDelay = min(retryDelay * 2, (unsigned long)RECONNECT_BACKOFF_MAX);
+    }
+    setState(state);
+    
+    Serial.print("[MQTT] Next attempt in ");
+    Serial.print(retryDelay);
+    Serial.println(" ms");
+}
+
+void MqttService::startWiFi() {
+    connectStart = millis();
+    
+#if WIFI_FAST_CONNECT
+    if (wifiCacheValid) {
+        Serial.print("[MQTT] Fast connect to WiFi: ");
+        Serial.print(wifiSSID);
+        Serial.print(" on channel ");
+        Serial.println(wifiCache.channel);
+        
+#if WIFI_CACHE_STATIC_IP
+        // Skips the DHCP round trip, the lease is the one from the last connect
+        WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway),
+                    IPAddress(wifiCache.subnet), IPAddress(wifiCache.dns));
+#endif
+        // No scan: straight to the cached access point
+        WiFi.begin(wifiSSID, wifiPassword, wifiCache.channel, wifiCache.bssid, true);
+        fastAttempt = true;
+        setState(STATE_WIFI_CONNECTING);
         return;
     }
+#endif
     
+    scanWiFi();
+}
+
+void MqttService::scanWiFi() {
     Serial.print("[MQTT] Connecting to WiFi: ");
     Serial.println(wifiSSID);
     
-    WiFi.begin(wifiSSID, wifiPassword);
+    if (fastAttempt) {
+        WiFi.disconnect();
+#if WIFI_CACHE_STATIC_IP
+        // Back to DHCP, the cached lease may be the reason the join failed
+        WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0));
+#endif
+        fastAttempt = false;
+    }
     
-    // Wait up to 10 seconds for connection
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
+    // Non-blocking, completion is polled in loop()
+    WiFi.begin(wifiSSID, wifiPassword);
+    setState(STATE_WIFI_CONNECTING);
+}
+
+void MqttService::wifiJoined() {
+    wifiConnected = true;
+    wifiConnectTime = min(millis() - connectStart, (unsigned long)0xFFFF);
+    wifiConnectFast = fastAttempt;
+    
+    Serial.print("[MQTT] WiFi connected in ");
+    Serial.print(wifiConnectTime);
+    Serial.print(fastAttempt ? " ms (fast)! IP: " : " ms! IP: ");
+    Serial.println(WiFi.localIP());
+    
+#if WIFI_FAST_CONNECT
+    saveWiFiCache();
+#endif
+}
+
+static uint32_t hashSsid(const char* ssid) {
+    // FNV-1a, only tells networks apart
+    uint32_t hash = 2166136261UL;
+    while (*ssid) {
+        hash = (hash ^ (uint8_t)*ssid++) * 16777619UL;
+    }
+    return hash;
+}
+
+static bool mountFileSystem() {
+#ifdef ESP32
+    return LittleFS.begin(true);
+#else
+    return LittleFS.begin();
+#endif
+}
+
+void MqttService::loadWiFiCache() {
+#if WIFI_FAST_CONNECT
+    wifiCacheValid = false;
+    if (!mountFileSystem()) {
+        return;
     }
     
-    if (WiFi.status() == WL_CONNECTED) {
-        wifiConnected = true;
-        Serial.println();
-        Serial.print("[MQTT] WiFi connected! IP: ");
-        Serial.println(WiFi.localIP());
-    } else {
-        wifiConnected = false;
-        Serial.println();
-        Serial.println("[MQTT] WiFi connection failed");
+    File file = LittleFS.open(WIFI_CACHE_FILE, "r");
+    if (!file) {
+        return;
     }
+    size_t length = file.read((uint8_t*)&wifiCache, sizeof(wifiCache));
+    file.close();
+    
+    wifiCacheValid = length == sizeof(wifiCache) && wifiCache.magic == WIFI_CACHE_MAGIC &&
+                     wifiCache.version == WIFI_CACHE_VERSION && wifiCache.ssidHash == hashSsid(wifiSSID) &&
+                     wifiCache.channel > 0;
+#endif
 }
 
-void MqttService::connectMQTT() {
-    if (!wifiConnected) {
+void MqttService::saveWiFiCache() {
+    WiFiCache current;
+    memset(&current, 0, sizeof(current));
+    current.magic = WIFI_CACHE_MAGIC;
+    current.version = WIFI_CACHE_VERSION;
+    current.channel = WiFi.channel();
+    current.ssidHash = hashSsid(wifiSSID);
+    memcpy(current.bssid, WiFi.BSSID(), sizeof(current.bssid));
+    current.ip = WiFi.localIP();
+    current.gateway = WiFi.gatewayIP();
+    current.subnet = WiFi.subnetMask();
+    current.dns = WiFi.dnsIP(0);
+    
+    // Flash is only written when the access point or the lease changed
+    if (wifiCacheValid && memcmp(&current, &wifiCache, sizeof(current)) == 0) {
         return;
     }
+    wifiCache = current;
+    wifiCacheValid = true;
     
+    if (!mountFileSystem()) {
+        return;
+    }
+    File file = LittleFS.open(WIFI_CACHE_FILE, "w");
+    if (!file) {
+        Serial.println("[MQTT] Unable to store the WiFi cache");
+        return;
+    }
+    file.write((const uint8_t*)&wifiCache, sizeof(wifiCache));
+    file.close();
+}
+
+bool MqttService::connectBroker() {
     Serial.print("[MQTT] Connecting to MQTT broker: ");
     Serial.print(mqttServer);
     Serial.print(":");
     Serial.println(mqttPort);
     
+    // A DNS lookup only on the first attempt after a WiFi join, the retries
+    // while the broker is down reuse the address
+    if (!brokerResolved) {
+#ifdef ESP8266
+        bool resolved = brokerIp.fromString(mqttServer) || WiFi.hostByName(mqttServer, brokerIp, MQTT_CONNECT_TIMEOUT);
+#else
+        bool resolved = brokerIp.fromString(mqttServer) || WiFi.hostByName(mqttServer, brokerIp);
+#endif
+        if (!resolved) {
+            Serial.println("[MQTT] Unable to resolve the broker address");
+            return false;
+        }
+        brokerResolved = true;
+        mqttClient.setServer(brokerIp, mqttPort);
+    }
+    
+    // Open the socket with a short timeout, PubSubClient::connect() uses the
+    // connected client instead of its own unbounded connect
+#ifdef ESP8266
+    wifiClient.setTimeout(MQTT_CONNECT_TIMEOUT);
+    bool reachable = wifiClient.connect(brokerIp, mqttPort);
+#else
+    bool reachable = wifiClient.connect(brokerIp, mqttPort, MQTT_CONNECT_TIMEOUT);
+#endif
+    if (!reachable) {
+        mqttConnected = false;
+        Serial.println("[MQTT] Broker unreachable");
+        return false;
+    }
+    
     bool connected;
     if (mqttUser && mqttPassword) {
         connected = mqttClient.connect(mqttClientId, mqttUser, mqttPassword);
@@ -315,65 +587,357 @@ void MqttService::connectMQTT() {
         connected = mqttClient.connect(mqttClientId);
     }
     
-    if (connected) {
-        mqttConnected = true;
-        Serial.println("[MQTT] MQTT connected!");
-    } else {
+    if (!connected) {
         mqttConnected = false;
         Serial.print("[MQTT] MQTT connection failed, rc=");
         Serial.println(mqttClient.state());
+        return false;
+    }
+    
+    mqttConnected = true;
+    Serial.println("[MQTT] MQTT connected!");
+    
+#if ENABLE_MQTT_COMMANDS
+    // Clean sessions drop subscriptions, so subscribe on every connect
+    if (!mqttClient.subscribe(commandTopic)) {
+        Serial.println("[MQTT] Failed to subscribe to command topics");
     }
+#endif
+    
+    if (everConnected) {
+        systemStatus("reconnected");
+    } else {
+        // Send startup message
+        everConnected = true;
+        systemStatus("online");
+        logInfo("Donation box system started");
+    }
+    return true;
 }
 
-bool MqttService::reconnect() {
-    if (!wifiConnected) {
-        return false;
+void MqttService::handleMessage(char* topic, uint8_t* payload, unsigned int length) {
+    // Runs inside mqttClient.loop(), topic and payload point into the PubSubClient buffer
+    if (!instance) {
+        return;
     }
     
-    Serial.print("[MQTT] Attempting MQTT reconnection...");
+    // Everything up to the "+" of the subscription filter must match
+    size_t prefixLength = strlen(instance->commandTopic) - 1;
+    if (strncmp(topic, instance->commandTopic, prefixLength) != 0) {
+        return;
+    }
+    instance->dispatchCommand(topic + prefixLength, payload, length);
+}
+
+void MqttService::dispatchCommand(const char* name, const uint8_t* payload, unsigned int length) {
+    for (const CommandSpec& spec : commandSpecs) {
+        if (strcmp(name, spec.name) != 0) {
+            continue;
+        }
+        
+        long value = 0;
+        if (spec.binary) {
+            if (!uploadHandler || !uploadHandler(spec.command, payload, length)) {
+                Serial.print("[MQTT] Upload not applied: ");
+                Serial.println(name);
+                return;
+            }
+            value = length;
+        } else if (spec.maxValue > spec.minValue &&
+            (!parseNumber(payload, length, value) || value < spec.minValue || value > spec.maxValue)) {
+            Serial.print("[MQTT] Invalid value for command ");
+            Serial.println(name);
+            return;
+        }
+        
+        Serial.print("[MQTT] Command ");
+        Serial.print(name);
+        Serial.print(" ");
+        Serial.println(value);
+        if (commandHandler) {
+            commandHandler(spec.command, value);
+        }
+        return;
+    }
     
-    bool connected;
-    if (mqttUser && mqttPassword) {
-        connected = mqttClient.connect(mqttClientId, mqttUser, mqttPassword);
-    } else {
-        connected = mqttClient.connect(mqttClientId);
+    Serial.print("[MQTT] Unknown command: ");
+    Serial.println(name);
+}
+
+bool MqttService::parseNumber(const uint8_t* payload, unsigned int length, long& value) {
+    // Digits only, surrounding whitespace is allowed (e.g. a trailing newline)
+    unsigned int i = 0;
+    while (i < length && isspace(payload[i])) {
+        i++;
     }
     
-    if (connected) {
-        mqttConnected = true;
-        Serial.println(" connected!");
-        systemStatus("reconnected");
+    unsigned int digits = 0;
+    value = 0;
+    while (i < length && isdigit(payload[i]) && digits < 9) {
+        value = value * 10 + (payload[i++] - '0');
+        digits++;
+    }
+    
+    while (i < length && isspace(payload[i])) {
+        i++;
+    }
+    return digits > 0 && i == length;
+}
+
+void MqttService::buildTopic(char* target, const char* suffix) {
+    snprintf(target, MQTT_TOPIC_LENGTH, "%s/%s", baseTopic, suffix);
+}
+
+void MqttService::publishLog(const char* level, const char* message) {
+    char timestamp[TIMESTAMP_LENGTH];
+    formatTimestamp(timestamp, sizeof(timestamp), millis());
+    
+    JsonWriter json(payloadBuffer, sizeof(payloadBuffer));
+    json.beginObject()
+        .field("timestamp", timestamp)
+        .field("level", level)
+        .field("message", message)
+        .endObject();
+    
+    mqttClient.publish(logTopic, json.c_str());
+}
+
+bool MqttService::publishDonation(const char* mode, int amount) {
+    char timestamp[TIMESTAMP_LENGTH];
+    formatTimestamp(timestamp, sizeof(timestamp), millis());
+    
+    JsonWriter json(payloadBuffer, sizeof(payloadBuffer));
+    json.beginObject()
+        .field("timestamp", timestamp)
+        .field("mode", mode)
+        .field("amount", amount)
+        .field("event", "donation")
+        .endObject();
+    
+    if (mqttClient.publish(donationTopic, json.c_str())) {
+        Serial.print("[MQTT] Donation published: ");
+        Serial.println(mode);
+        return true;
+    }
+    Serial.println("[MQTT] Failed to publish donation");
+    return false;
+}
+
+bool MqttService::publishModeChange(const char* fromMode, const char* toMode) {
+    char timestamp[TIMESTAMP_LENGTH];
+    formatTimestamp(timestamp, sizeof(timestamp), millis());
+    
+    JsonWriter json(payloadBuffer, sizeof(payloadBuffer));
+    json.beginObject()
+        .field("timestamp", timestamp)
+        .field("from_mode", fromMode)
+        .field("to_mode", toMode)
+        .field("event", "mode_change")
+        .endObject();
+    
+    if (mqttClient.publish(modeTopic, json.c_str())) {
+        Serial.print("[MQTT] Mode change published: ");
+        Serial.print(fromMode);
+        Serial.print(" -> ");
+        Serial.println(toMode);
         return true;
+    }
+    Serial.println("[MQTT] Failed to publish mode change");
+    return false;
+}
+
+void MqttService::flushEventQueue() {
+    if (eventQueue.isEmpty()) {
+        return;
+    }
+    
+    // The packet buffer also holds the fixed header (up to 5 bytes), the
+    // topic length (2) and the topic, the payload gets the rest
+    size_t maxPayload = MQTT_BUFFER_SIZE - 7 - strlen(backlogTopic);
+    uint8_t batch = min(eventQueue.size(), (uint8_t)EVENT_BATCH_SIZE);
+    
+    // One event at a time into the space left before the closing bracket, the
+    // first one that does not fit ends the batch and stays queued
+    size_t length = 0;
+    payloadBuffer[length++] = '[';
+    uint8_t written = 0;
+    while (written < batch) {
+        size_t start = written > 0 ? length + 1 : length; // Behind the comma
+        if (start + 1 >= maxPayload) {
+            break;
+        }
+        JsonWriter json(payloadBuffer + start, maxPayload - start);
+        writeEvent(json, *eventQueue.peek(written));
+        if (json.overflowed()) {
+            break;
+        }
+        if (written > 0) {
+            payloadBuffer[length] = ',';
+        }
+        length = start + json.size();
+        written++;
+    }
+    
+    if (written == 0) {
+        // Would block the backlog forever
+        eventQueue.pop();
+        logWarning("Queued event exceeds MQTT_BUFFER_SIZE, dropped");
+        return;
+    }
+    payloadBuffer[length++] = ']';
+    payloadBuffer[length] = '\0';
+    
+    if (!mqttClient.publish(backlogTopic, payloadBuffer)) {
+        // Keep the events, retry on the next loop
+        Serial.println("[MQTT] Failed to publish event backlog");
+        return;
+    }
+    
+    eventQueue.pop(written);
+    Serial.print("[MQTT] Replayed ");
+    Serial.print(written);
+    Serial.print(" queued events, ");
+    Serial.print(eventQueue.size());
+    Serial.println(" remaining");
+    
+    if (eventQueue.isEmpty() && eventQueue.getDropped() > 0) {
+        char message[64];
+        snprintf(message, sizeof(message), "%u queued events were dropped while offline", eventQueue.getDropped());
+        logWarning(message);
+        eventQueue.resetDropped();
+    }
+}
+
+void MqttService::writeMemory(JsonWriter& json) {
+    MemoryStats memory;
+    MemoryMonitor::read(memory);
+    
+    json.field("free_heap", (unsigned long)memory.freeHeap)
+        .field("min_free_heap", (unsigned long)memory.minFreeHeap)
+        .field("largest_block", (unsigned long)memory.largestBlock)
+        .field("heap_fragmentation", (unsigned int)memory.fragmentation)
+        .field("loop_stack_free", (unsigned long)memory.loopStackFree);
+#if ENABLE_DUAL_CORE
+    json.field("io_stack_free", (unsigned long)memory.ioStackFree);
+#endif
+}
+
+void MqttService::writeEvent(JsonWriter& json, const EventQueue::Event& event) {
+    char timestamp[TIMESTAMP_LENGTH];
+    formatTimestamp(timestamp, sizeof(timestamp), event.timestamp);
+    
+    json.beginObject().field("timestamp", timestamp);
+    if (event.type == EventQueue::EVENT_DONATION) {
+        json.field("mode", event.mode)
+            .field("amount", event.amount)
+            .field("event", "donation");
     } else {
-        mqttConnected = false;
-        Serial.print(" failed, rc=");
-        Serial.println(mqttClient.state());
-        return false;
+        json.field("from_mode", event.fromMode)
+            .field("to_mode", event.mode)
+            .field("event", "mode_change");
+    }
+    if (event.flags & EventQueue::FLAG_PREVIOUS_BOOT) {
+        json.field("previous_boot", true);
+    } else {
+        json.field("age_ms", millis() - event.timestamp);
     }
+    json.endObject();
 }
 
 void MqttService::publishHeartbeat() {
-    String payload = "{";
-    payload += "\"timestamp\":\"" + formatTimestamp() + "\",";
-    payload += "\"event\":\"heartbeat\",";
-    payload += "\"uptime\":" + String(millis()) + ",";
-    payload += "\"free_heap\":" + String(ESP.getFreeHeap());
-    payload += "}";
+#if MQTT_BINARY_TELEMETRY
+    BinaryWriter record((uint8_t*)payloadBuffer, sizeof(payloadBuffer));
+    writeRecordHeader(record, RECORD_HEARTBEAT);
+    mqttClient.publish(heartbeatTopic, record.data(), record.size());
+#else
+    char timestamp[TIMESTAMP_LENGTH];
+    formatTimestamp(timestamp, sizeof(timestamp), millis());
+    
+    JsonWriter json(payloadBuffer, sizeof(payloadBuffer));
+    json.beginObject()
+        .field("timestamp", timestamp)
+        .field("event", "heartbeat")
+        .field("uptime", millis());
+    writeMemory(json);
+    json.endObject();
+    
+    mqttClient.publish(heartbeatTopic, json.c_str());
+#endif
+}
+
+void MqttService::writeRecordHeader(BinaryWriter& record, uint8_t type) {
+    MemoryStats memory;
+    MemoryMonitor::read(memory);
+    
+    uint8_t flags = (wifiConnected ? RECORD_WIFI_CONNECTED : 0) | (mqttConnected ? RECORD_MQTT_CONNECTED : 0) |
+                    (wifiConnectFast ? RECORD_WIFI_FAST : 0);
+#if ENABLE_DUAL_CORE
+    flags |= RECORD_IO_STACK;
+#endif
+    
+    // Version, type and flags, then the fields of writeMemory() in fixed order (24 bytes)
+    record.u8(TELEMETRY_VERSION)
+          .u8(type)
+          .u8(flags)
+          .u32(millis())
+          .u32(memory.freeHeap)
+          .u32(memory.minFreeHeap)
+          .u32(memory.largestBlock)
+          .u8(memory.fragmentation)
+          .u16(min(memory.loopStackFree, (uint32_t)0xFFFF))
+          .u16(min(memory.ioStackFree, (uint32_t)0xFFFF));
+}
+
+void MqttService::publishMetrics() {
+    ProfileSnapshot snapshot;
+    Profiler::snapshot(snapshot);
+    
+    char timestamp[TIMESTAMP_LENGTH];
+    formatTimestamp(timestamp, sizeof(timestamp), millis());
+    
+    JsonWriter json(payloadBuffer, sizeof(payloadBuffer));
+    json.beginObject()
+        .field("timestamp", timestamp)
+        .field("event", "metrics")
+        .field("window_ms", snapshot.windowMs)
+        .field("frames", (unsigned long)snapshot.frames)
+        .field("missed_frames", (unsigned long)snapshot.missedFrames)
+        .field("max_frame_gap_ms", (unsigned long)snapshot.maxFrameGap)
+        .beginObject("timers");
+    
+    for (uint8_t point = 0; point < PROFILE_POINT_COUNT; point++) {
+        const TimerStats& stats = snapshot.timers[point];
+        json.beginObject(Profiler::name((ProfilePoint)point))
+            .field("n", (unsigned long)stats.count)
+            .field("mean_us", (unsigned long)(stats.count ? stats.totalUs / stats.count : 0))
+            .field("max_us", (unsigned long)stats.maxUs);
+        
+        // Power-of-two buckets in us, trailing empty buckets are left out
+        uint8_t used = PROFILE_BUCKETS;
+        while (used > 0 && stats.histogram[used - 1] == 0) {
+            used--;
+        }
+        json.beginArray("hist");
+        for (uint8_t bucket = 0; bucket < used; bucket++) {
+            json.value(stats.histogram[bucket]);
+        }
+        json.endArray().endObject();
+    }
+    json.endObject().endObject();
     
-    mqttClient.publish((baseTopic + "/heartbeat").c_str(), payload.c_str());
+    if (json.overflowed()) {
+        Serial.println("[MQTT] Metrics payload too large for MQTT_BUFFER_SIZE, skipped");
+        return;
+    }
+    mqttClient.publish(metricsTopic, json.c_str());
 }
 
-String MqttService::formatTimestamp() {
+void MqttService::formatTimestamp(char* target, size_t size, unsigned long now) {
     // Simple timestamp using millis() - in production you'd use NTP time
-    unsigned long now = millis();
     unsigned long seconds = now / 1000;
     unsigned long minutes = seconds / 60;
     unsigned long hours = minutes / 60;
     
-    String timestamp = String(hours % 24) + ":";
-    timestamp += String((minutes % 60) < 10 ? "0" : "") + String(minutes % 60) + ":";
-    timestamp += String((seconds % 60) < 10 ? "0" : "") + String(seconds % 60);
-    
-    return timestamp;
+    snprintf(target, size, "%lu:%02lu:%02lu", hours % 24, minutes % 60, seconds % 60);
 }
 #endif
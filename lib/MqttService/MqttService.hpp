@@ -10,7 +10,28 @@
   #include <WiFi.h>
 #endif
 #include <PubSubClient.h>
+#include "EventQueue.hpp"
+#include "JsonWriter.hpp"
+#include "BinaryWriter.hpp"
+#include "Profiler.hpp"
+#include "MemoryMonitor.hpp"
 #endif
+#include "DonationStats.hpp"
+
+// Remote commands on <base topic>/cmd/<name>, the payload is a plain decimal number
+enum MqttCommand : uint8_t {
+    COMMAND_MODE,       // "mode": switch to mode index
+    COMMAND_DONATION,   // "donation": test donation, payload ignored
+    COMMAND_VOLUME,     // "volume": DFPlayer volume 0-30
+    COMMAND_BRIGHTNESS, // "brightness": LED brightness limit 0-255
+    COMMAND_ANIMATION,  // "animation": binary AnimationMode program, value is its length
+    COMMAND_UPDATE      // "update": "<url> <md5>" firmware image for OtaService, value is the payload length
+};
+
+// Called from MqttService::loop(), i.e. on the I/O side
+typedef void (*MqttCommandHandler)(MqttCommand command, long value);
+// Binary payloads, also on the I/O side; the command handler only runs if it returns true
+typedef bool (*MqttUploadHandler)(MqttCommand command, const uint8_t* data, unsigned int length);
 
 class MqttService {
 private:
@@ -23,31 +44,97 @@ private:
     const char* wifiPassword;
     const char* mqttServer;
     int mqttPort;
+    IPAddress brokerIp;            // Resolved once per WiFi join
+    bool brokerResolved = false;
     const char* mqttClientId;
     const char* mqttUser;
     const char* mqttPassword;
     
-    // Topics
-    String baseTopic;
-    String donationTopic;
-    String logTopic;
-    String statusTopic;
-    String modeTopic;
+    // Topics - built once in setBaseTopic(), not per publish
+    char baseTopic[MQTT_TOPIC_LENGTH];
+    char donationTopic[MQTT_TOPIC_LENGTH];
+    char logTopic[MQTT_TOPIC_LENGTH];
+    char statusTopic[MQTT_TOPIC_LENGTH];
+    char modeTopic[MQTT_TOPIC_LENGTH];
+    char backlogTopic[MQTT_TOPIC_LENGTH];
+    char heartbeatTopic[MQTT_TOPIC_LENGTH];
+    char metricsTopic[MQTT_TOPIC_LENGTH];
+    char statsTopic[MQTT_TOPIC_LENGTH];
+    char commandTopic[MQTT_TOPIC_LENGTH]; // Subscription filter, ends in "/cmd/+"
+    
+    // Remote commands, PubSubClient only takes a plain callback
+    MqttCommandHandler commandHandler = nullptr;
+    MqttUploadHandler uploadHandler = nullptr;
+    static MqttService* instance;
+    static void handleMessage(char* topic, uint8_t* payload, unsigned int length);
+    void dispatchCommand(const char* name, const uint8_t* payload, unsigned int length);
+    static bool parseNumber(const uint8_t* payload, unsigned int length, long& value);
+    
+    // Shared buffer for every payload, publishing is single threaded
+    char payloadBuffer[MQTT_BUFFER_SIZE];
+    static const size_t TIMESTAMP_LENGTH = 16;
+    
+    // Events waiting for the broker
+    EventQueue eventQueue;
+    
+    // Connection state machine - every step returns immediately
+    enum ConnectionState : uint8_t {
+        STATE_WIFI_WAIT,       // Waiting for the next WiFi attempt
+        STATE_WIFI_CONNECTING, // WiFi.begin() issued, polling status
+        STATE_MQTT_WAIT,       // WiFi up, waiting for the next broker attempt
+        STATE_MQTT_CONNECTED   // Fully connected
+    };
     
     // State management
+    ConnectionState connectionState;
     bool wifiConnected;
     bool mqttConnected;
-    unsigned long lastReconnectAttempt;
+    bool everConnected;
+    unsigned long stateSince;
+    unsigned long retryDelay;
     unsigned long lastHeartbeat;
-    static const unsigned long RECONNECT_INTERVAL = 5000;
     static const unsigned long HEARTBEAT_INTERVAL = 30000;
+    unsigned long lastMetrics;
+    
+    // Last good access point and lease, stored in LittleFS after every connect
+    struct WiFiCache {
+        uint16_t magic;
+        uint8_t version;
+        uint8_t channel;
+        uint32_t ssidHash; // A cache from another network is ignored
+        uint8_t bssid[6];
+        uint32_t ip;
+        uint32_t gateway;
+        uint32_t subnet;
+        uint32_t dns;
+    };
+    WiFiCache wifiCache;
+    bool wifiCacheValid = false;
+    bool fastAttempt = false;      // The running attempt joins the cached access point
+    unsigned long connectStart = 0;
+    uint16_t wifiConnectTime = 0;  // Last WiFi connect in ms, reported with the status
+    bool wifiConnectFast = false;
     
     // Internal methods
-    void connectWiFi();
-    void connectMQTT();
-    bool reconnect();
+    void setState(ConnectionState state);
+    void scheduleRetry(ConnectionState state);
+    void startWiFi();
+    void scanWiFi();
+    void wifiJoined();
+    void loadWiFiCache();
+    void saveWiFiCache();
+    bool connectBroker();
+    void buildTopic(char* target, const char* suffix);
     void publishHeartbeat();
-    String formatTimestamp();
+    void publishMetrics();
+    void publishLog(const char* level, const char* message);
+    bool publishDonation(const char* mode, int amount);
+    bool publishModeChange(const char* fromMode, const char* toMode);
+    void flushEventQueue();
+    void writeEvent(JsonWriter& json, const EventQueue::Event& event);
+    static void writeMemory(JsonWriter& json);
+    void writeRecordHeader(BinaryWriter& record, uint8_t type);
+    static void formatTimestamp(char* target, size_t size, unsigned long ms);
 #else
     // Dummy mode - no actual network functionality
     bool dummyConnected = false;
@@ -63,19 +150,32 @@ public:
     void setup();
     void loop();
     
-    // Publishing methods
-    void donation(const String& mode, int amount = 1);
-    void logInfo(const String& message);
-    void logWarning(const String& message);
-    void logError(const String& message);
-    void modeChanged(const String& fromMode, const String& toMode);
-    void systemStatus(const String& status);
+    // Publishing methods - payloads are built in a static buffer, no heap allocations
+    void donation(const char* mode, int amount = 1);
+    void logInfo(const char* message);
+    void logWarning(const char* message);
+    void logError(const char* message);
+    void modeChanged(const char* fromMode, const char* toMode);
+    void systemStatus(const char* status);
+    bool donationStats(const DonationSummary& stats); // Retained, false if not sent
+    
+    // String convenience overloads
+    void donation(const String& mode, int amount = 1) { donation(mode.c_str(), amount); }
+    void logInfo(const String& message) { logInfo(message.c_str()); }
+    void logWarning(const String& message) { logWarning(message.c_str()); }
+    void logError(const String& message) { logError(message.c_str()); }
+    void modeChanged(const String& fromMode, const String& toMode) { modeChanged(fromMode.c_str(), toMode.c_str()); }
+    void systemStatus(const String& status) { systemStatus(status.c_str()); }
     
     // Status methods
     bool isConnected() const;
     bool isWiFiConnected() const;
     String getConnectionStatus() const;
+    uint8_t getQueuedEvents() const;
     
     // Configuration methods
-    void setBaseTopic(const String& topic);
+    void setBaseTopic(const char* topic);
+    void setCommandHandler(MqttCommandHandler handler);
+    void setUploadHandler(MqttUploadHandler handler);
+    void setBaseTopic(const String& topic) { setBaseTopic(topic.c_str()); }
 };
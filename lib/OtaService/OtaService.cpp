@@ -0,0 +1,253 @@
+#include "OtaService.hpp"
+
+#ifdef ESP8266
+  #include <Updater.h>
+#else
+  #include <Update.h>
+#endif
+
+bool OtaService::start(const uint8_t* payload, unsigned int length) {
+    if (isBusy()) {
+        Serial.println("[OTA] Update already running, request ignored");
+        return false;
+    }
+
+    // "<url> <md5>", surrounding whitespace (e.g. a trailing newline) is allowed
+    char request[OTA_URL_LENGTH + 40];
+    if (length >= sizeof(request)) {
+        Serial.println("[OTA] Request too long");
+        return false;
+    }
+    memcpy(request, payload, length);
+    request[length] = '\0';
+
+    char* save = nullptr;
+    char* urlPart = strtok_r(request, " \t\r\n", &save);
+    char* md5Part = strtok_r(nullptr, " \t\r\n", &save);
+    if (!urlPart || !md5Part || strtok_r(nullptr, " \t\r\n", &save) ||
+        strncmp(urlPart, "http://", 7) != 0 || strlen(urlPart) >= sizeof(url) || strlen(md5Part) != 32) {
+        Serial.println("[OTA] Expected \"http://<host>/<image> <md5>\"");
+        return false;
+    }
+
+    // Retained requests come back after the reboot into the new image
+    if (strcasecmp(md5Part, ESP.getSketchMD5().c_str()) == 0) {
+        Serial.println("[OTA] Image is already running");
+        return false;
+    }
+
+    strcpy(url, urlPart);
+    strcpy(md5, md5Part);
+    state = OTA_PENDING;
+    return true;
+}
+
+void OtaService::loop() {
+    switch (state) {
+        case OTA_PENDING:
+            connect();
+            break;
+        case OTA_REQUESTED:
+            readHeaders();
+            break;
+        case OTA_DOWNLOADING:
+            download();
+            break;
+        case OTA_DONE:
+            // Give MQTT time to send the last status
+            if (millis() - doneTime >= OTA_RESTART_DELAY) {
+                Serial.println("[OTA] Restarting into the new firmware");
+                ESP.restart();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void OtaService::connect() {
+    Serial.print("[OTA] Downloading ");
+    Serial.println(url);
+
+    // "http://<host>[:<port>]/<path>", checked for the scheme in start()
+    const char* hostStart = url + 7;
+    const char* path = strchr(hostStart, '/');
+    size_t hostLength = path ? (size_t)(path - hostStart) : strlen(hostStart);
+    if (!path) {
+        path = "/";
+    }
+    char host[64];
+    if (hostLength == 0 || hostLength >= sizeof(host)) {
+        fail("Invalid update URL");
+        return;
+    }
+    memcpy(host, hostStart, hostLength);
+    host[hostLength] = '\0';
+
+    uint16_t port = 80;
+    char* portPart = strchr(host, ':');
+    if (portPart) {
+        *portPart++ = '\0';
+        port = atoi(portPart);
+    }
+
+    // The only blocking step, a LAN server answers within milliseconds
+#ifdef ESP8266
+    client.setTimeout(OTA_CONNECT_TIMEOUT);
+    bool connected = client.connect(host, port);
+#else
+    bool connected = client.connect(host, port, OTA_CONNECT_TIMEOUT);
+#endif
+    if (!connected) {
+        fail("Update server unreachable");
+        return;
+    }
+
+    // HTTP/1.0, so the body is neither chunked nor kept alive
+    client.print("GET ");
+    client.print(path);
+    client.print(" HTTP/1.0\r\nHost: ");
+    client.print(host);
+    client.print("\r\nConnection: close\r\n\r\n");
+
+    lineLength = 0;
+    statusCode = 0;
+    contentLength = -1;
+    lastData = millis();
+    state = OTA_REQUESTED;
+}
+
+void OtaService::readHeaders() {
+    // Only what has arrived, the rest follows in the next passes
+    while (client.available() > 0) {
+        int c = client.read();
+        if (c < 0) {
+            break;
+        }
+        lastData = millis();
+        if (c == '\r') {
+            continue;
+        }
+        if (c != '\n') {
+            if (lineLength < sizeof(line) - 1) {
+                line[lineLength++] = c;
+            }
+            continue;
+        }
+        line[lineLength] = '\0';
+        lineLength = 0;
+        if (!headerLine()) {
+            return;
+        }
+    }
+
+    if (state != OTA_REQUESTED) {
+        return;
+    }
+    if (!client.connected() && client.available() == 0) {
+        fail("Update download interrupted");
+    } else if (millis() - lastData >= OTA_TIMEOUT) {
+        fail("Update server did not answer");
+    }
+}
+
+bool OtaService::headerLine() {
+    if (statusCode == 0) {
+        // "HTTP/1.1 200 OK"
+        const char* code = strchr(line, ' ');
+        statusCode = code ? atoi(code + 1) : -1;
+        if (statusCode != 200) {
+            fail("Update server refused the request");
+            return false;
+        }
+        return true;
+    }
+
+    if (line[0] != '\0') {
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            contentLength = atol(line + 15);
+        }
+        return true;
+    }
+
+    // Empty line, the image follows
+    if (contentLength <= 0) {
+        fail("Update server did not send the image size");
+        return false;
+    }
+    if (!Update.begin(contentLength)) {
+        fail("Image does not fit the update partition");
+        return false;
+    }
+    Update.setMD5(md5);
+
+    imageSize = contentLength;
+    written = 0;
+    reportedTenth = 0;
+    state = OTA_DOWNLOADING;
+    report("Update download started");
+    return false;
+}
+
+void OtaService::download() {
+    int available = client.available();
+
+    if (available <= 0) {
+        if (!client.connected()) {
+            fail("Update download interrupted");
+        } else if (millis() - lastData >= OTA_TIMEOUT) {
+            fail("Update download timed out");
+        }
+        return;
+    }
+
+    // One chunk per pass, the flash write is the slow part
+    size_t chunk = min(min((size_t)available, sizeof(buffer)), (size_t)(imageSize - written));
+    size_t received = client.read(buffer, chunk);
+    if (Update.write(buffer, received) != received) {
+        fail("Writing the update partition failed");
+        return;
+    }
+    written += received;
+    lastData = millis();
+
+    uint8_t tenth = (uint64_t)written * 10 / imageSize;
+    if (tenth != reportedTenth && tenth < 10) {
+        reportedTenth = tenth;
+        char message[40];
+        snprintf(message, sizeof(message), "Update download %u%%", tenth * 10);
+        report(message);
+    }
+
+    if (written < imageSize) {
+        return;
+    }
+
+    client.stop();
+    // end() checks the MD5 and marks the new image as the boot partition
+    if (!Update.end()) {
+        state = OTA_FAILED;
+        report("Update image failed verification");
+        return;
+    }
+    state = OTA_DONE;
+    doneTime = millis();
+    report("Update verified, restarting");
+}
+
+void OtaService::fail(const char* reason) {
+    if (state == OTA_DOWNLOADING) {
+        Update.end(false); // Discards the partial image
+    }
+    client.stop();
+    state = OTA_FAILED;
+    report(reason);
+}
+
+void OtaService::report(const char* message) {
+    Serial.print("[OTA] ");
+    Serial.println(message);
+    if (statusHandler) {
+        statusHandler(message);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef OTA_SERVICE_HPP
+#define OTA_SERVICE_HPP
+
+#include <Arduino.h>
+
+#ifdef ESP8266
+  #include <ESP8266WiFi.h>
+#else
+  #include <WiFi.h>
+#endif
+
+#include "Config.h"
+
+enum OtaState : uint8_t {
+    OTA_IDLE,
+    OTA_PENDING,     // Accepted, the download starts on the next loop()
+    OTA_REQUESTED,   // Request sent, reading the response headers
+    OTA_DOWNLOADING,
+    OTA_DONE,        // Verified, restarting after OTA_RESTART_DELAY
+    OTA_FAILED       // A new request may be started
+};
+
+// Progress and result messages, e.g. forwarded to the MQTT status topic
+typedef void (*OtaStatusHandler)(const char* message);
+
+/**
+ * OtaService - firmware update over HTTP, triggered over MQTT
+ * Runs on the I/O side: loop() never waits for the server, it handles the
+ * response headers that have arrived and moves at most OTA_CHUNK_SIZE bytes
+ * into the update partition, so the render loop keeps going while the image
+ * downloads. Only the TCP connect blocks, for at most OTA_CONNECT_TIMEOUT.
+ * The image is checked against the MD5 from the request before the box
+ * boots it.
+ */
+class OtaService {
+    private:
+        char url[OTA_URL_LENGTH];
+        char md5[33];
+        OtaState state = OTA_IDLE;
+        OtaStatusHandler statusHandler = nullptr;
+
+        WiFiClient client;
+        uint8_t buffer[OTA_CHUNK_SIZE];
+        char line[64];                // Response header line, longer ones are cut
+        uint8_t lineLength = 0;
+        int statusCode = 0;           // 0 until the status line was read
+        long contentLength = -1;
+        uint32_t imageSize = 0;
+        uint32_t written = 0;
+        uint8_t reportedTenth = 0;    // Progress already reported, in 10 % steps
+        unsigned long lastData = 0;   // Time of the last received header byte or chunk
+        unsigned long doneTime = 0;
+
+        void connect();
+        void readHeaders();
+        bool headerLine();
+        void download();
+        void fail(const char* reason);
+        void report(const char* message);
+
+    public:
+        // Payload "<http url> <md5>", called by the MQTT upload handler.
+        // False if busy, malformed, or the image is the running one.
+        bool start(const uint8_t* payload, unsigned int length);
+        void loop();
+
+        void setStatusHandler(OtaStatusHandler handler) { statusHandler = handler; }
+
+        OtaState getState() const { return state; }
+        bool isBusy() const { return state != OTA_IDLE && state != OTA_FAILED; }
+        uint8_t getProgress() const { return imageSize ? (uint64_t)written * 100 / imageSize : 0; }
+};
+
+#endif // OTA_SERVICE_HPP
@@ -0,0 +1,103 @@
+#include "PowerManager.hpp"
+#include "Profiler.hpp"
+
+#if ENABLE_WIFI
+#ifdef ESP8266
+  #include <ESP8266WiFi.h>
+#else
+  #include <WiFi.h>
+#endif
+#endif
+
+#ifdef ESP32
+TaskHandle_t PowerManager::loopTask = nullptr;
+static uint32_t activeCpuMhz = 0;
+#endif
+
+void PowerManager::setup() {
+#ifdef ESP32
+    loopTask = xTaskGetCurrentTaskHandle();
+    activeCpuMhz = getCpuFrequencyMhz();
+#endif
+    lastActivity = millis();
+}
+
+void PowerManager::wake() {
+    lastActivity = millis();
+    if (idle) {
+        // Full frame rate for the very next frame, the rest follows in loop()
+        controller->setTargetFps(TARGET_FPS);
+        wakeRequested = true;
+    }
+}
+
+void PowerManager::loop() {
+    if (wakeRequested) {
+        wakeRequested = false;
+        exitIdle();
+    } else if (!idle && millis() - lastActivity >= IDLE_TIMEOUT) {
+        enterIdle();
+    }
+}
+
+void PowerManager::enterIdle() {
+    idle = true;
+    controller->setTargetFps(IDLE_FPS);
+    // Dithering would still re-show the strip at TARGET_FPS
+    lightService->setRefreshEnabled(false);
+#ifdef ESP32
+#if IDLE_CPU_MHZ > 0
+    setCpuFrequencyMhz(IDLE_CPU_MHZ);
+    Profiler::setCpuMhz(getCpuFrequencyMhz());
+#endif
+#if ENABLE_WIFI
+    // Wake for fewer DTIM beacons, the connection stays up
+    WiFi.setSleep(WIFI_PS_MAX_MODEM);
+#endif
+#endif
+    Serial.println("[POWER] No donations for a while, entering idle mode");
+}
+
+void PowerManager::exitIdle() {
+    idle = false;
+    controller->setTargetFps(TARGET_FPS);
+    lightService->setRefreshEnabled(true);
+#ifdef ESP32
+#if IDLE_CPU_MHZ > 0
+    setCpuFrequencyMhz(activeCpuMhz);
+    Profiler::setCpuMhz(getCpuFrequencyMhz());
+#endif
+#if ENABLE_WIFI
+    WiFi.setSleep(WIFI_PS_MIN_MODEM); // Arduino default
+#endif
+#endif
+    Serial.println("[POWER] Activity, leaving idle mode");
+}
+
+void PowerManager::sleep(unsigned long ms) {
+    if (ms == 0) {
+        return;
+    }
+    
+#ifdef ESP32
+    if (idle) {
+        // Blocks the loop task, the idle task puts the CPU to sleep until the
+        // frame is due or wakeFromIsr() reports a sensor edge
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+        return;
+    }
+#endif
+    delay(1);
+}
+
+void IRAM_ATTR PowerManager::wakeFromIsr() {
+#ifdef ESP32
+    if (loopTask) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(loopTask, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    }
+#endif
+}
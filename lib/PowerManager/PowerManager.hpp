@@ -0,0 +1,54 @@
+#ifndef POWER_MANAGER_HPP
+#define POWER_MANAGER_HPP
+
+#include <Arduino.h>
+
+#include "Config.h"
+#include "Controller.hpp"
+#include "LightService.hpp"
+
+/**
+ * PowerManager - idle power mode between donations
+ * After IDLE_TIMEOUT without a donation the Controller renders at IDLE_FPS,
+ * the ESP32 drops its CPU clock and WiFi modem sleep skips more beacons.
+ * The LED refresh for dithering and crossfades is suspended, so the strip is
+ * only written when the idle frame changes.
+ * Between frames loop() blocks until the next frame or the sensor interrupt
+ * instead of polling every millisecond.
+ */
+class PowerManager : public ControllerObserver {
+    private:
+        Controller* controller;
+        LightService* lightService;
+        bool idle = false;
+        bool wakeRequested = false; // Set by wake(), applied in loop()
+        unsigned long lastActivity = 0;
+#ifdef ESP32
+        static TaskHandle_t loopTask;
+#endif
+
+        void enterIdle();
+        void exitIdle();
+
+    public:
+        PowerManager(Controller* controller, LightService* lightService)
+            : controller(controller), lightService(lightService) {}
+
+        // Call from setup(), in the task that runs loop()
+        void setup();
+        void loop();
+
+        // Any activity that should end the idle mode (donations end it on their own)
+        void wake();
+        bool isIdle() const { return idle; }
+
+        // Wait up to ms for the next frame; returns early on a sensor edge while idle
+        void sleep(unsigned long ms);
+
+        // Sensor edge hook, runs in the GPIO interrupt
+        static void IRAM_ATTR wakeFromIsr();
+
+        void onDonation(uint8_t modeIndex, unsigned long timestampMs) override { wake(); }
+};
+
+#endif // POWER_MANAGER_HPP
@@ -0,0 +1,84 @@
+#include "Profiler.hpp"
+
+// With ENABLE_DUAL_CORE both cores record, the snapshot runs on the I/O core
+#ifdef ESP32
+static portMUX_TYPE profilerMux = portMUX_INITIALIZER_UNLOCKED;
+#define PROFILER_LOCK()   portENTER_CRITICAL(&profilerMux)
+#define PROFILER_UNLOCK() portEXIT_CRITICAL(&profilerMux)
+#else
+#define PROFILER_LOCK()
+#define PROFILER_UNLOCK()
+#endif
+
+ProfileSnapshot Profiler::current = {};
+unsigned long Profiler::windowStart = 0;
+uint32_t Profiler::cyclesPerUs = 1;
+
+void Profiler::setup() {
+#ifndef NATIVE
+    setCpuMhz(ESP.getCpuFreqMHz());
+#endif
+    windowStart = millis();
+}
+
+void Profiler::setCpuMhz(uint32_t mhz) {
+    // A single aligned word, the other core reads it without the lock
+    cyclesPerUs = mhz == 0 ? 1 : mhz;
+}
+
+void Profiler::record(ProfilePoint point, uint32_t us) {
+    // Highest set bit = power-of-two bucket
+    uint8_t bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+    if (bucket >= PROFILE_BUCKETS) {
+        bucket = PROFILE_BUCKETS - 1;
+    }
+    
+    PROFILER_LOCK();
+    TimerStats& stats = current.timers[point];
+    stats.count++;
+    stats.totalUs += us;
+    if (us > stats.maxUs) {
+        stats.maxUs = us;
+    }
+    if (stats.histogram[bucket] < UINT16_MAX) {
+        stats.histogram[bucket]++;
+    }
+    PROFILER_UNLOCK();
+}
+
+void Profiler::recordFrame(unsigned long dt, unsigned long interval) {
+    PROFILER_LOCK();
+    current.frames++;
+    // A frame that comes two intervals late has skipped one slot
+    if (interval > 0 && dt >= 2 * interval) {
+        current.missedFrames += dt / interval - 1;
+    }
+    if (dt > current.maxFrameGap) {
+        current.maxFrameGap = dt;
+    }
+    PROFILER_UNLOCK();
+}
+
+void Profiler::snapshot(ProfileSnapshot& target) {
+    unsigned long nowMs = millis();
+    
+    PROFILER_LOCK();
+    target = current;
+    current = {};
+    PROFILER_UNLOCK();
+    
+    target.windowMs = nowMs - windowStart;
+    windowStart = nowMs;
+}
+
+const char* Profiler::name(ProfilePoint point) {
+    switch (point) {
+        case PROFILE_LOOP:       return "loop";
+        case PROFILE_CONTROLLER: return "controller";
+        case PROFILE_SENSOR:     return "sensor";
+        case PROFILE_SPEAKER:    return "speaker";
+        case PROFILE_MQTT:       return "mqtt";
+        case PROFILE_SHOW:       return "show";
+        default:                 return "unknown";
+    }
+}
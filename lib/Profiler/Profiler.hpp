@@ -0,0 +1,89 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Instrumented hot paths
+enum ProfilePoint : uint8_t {
+    PROFILE_LOOP,       // Whole loop() iteration (without the idle delay)
+    PROFILE_CONTROLLER, // Controller::loop(), includes mode rendering
+    PROFILE_SENSOR,     // SensorService::loop()
+    PROFILE_SPEAKER,    // SpeakerService::loop()
+    PROFILE_MQTT,       // MqttService::loop()
+    PROFILE_SHOW,       // LED driver show() (FastLED.show() on the boards)
+    PROFILE_POINT_COUNT
+};
+
+// Bucket i counts durations of [2^i, 2^(i+1)) us, the last bucket everything above
+#define PROFILE_BUCKETS 16
+
+struct TimerStats {
+    uint32_t count;
+    uint32_t totalUs;
+    uint32_t maxUs;
+    uint16_t histogram[PROFILE_BUCKETS];
+};
+
+struct ProfileSnapshot {
+    TimerStats timers[PROFILE_POINT_COUNT];
+    uint32_t frames;       // Rendered frames
+    uint32_t missedFrames; // Frame slots skipped because the loop was late
+    uint32_t maxFrameGap;  // Longest time between two frames in ms
+    unsigned long windowMs; // Time covered by this snapshot
+};
+
+/**
+ * Profiler - cheap timers and counters for the hot paths
+ * Durations come from the CPU cycle counter on the boards. Aggregation is
+ * a fixed histogram per point, snapshot() hands it out and starts over.
+ */
+class Profiler {
+    private:
+        static ProfileSnapshot current;
+        static unsigned long windowStart;
+        static uint32_t cyclesPerUs;
+
+    public:
+        static void setup();
+        // After setCpuFrequencyMhz(), cycles are converted at the new clock
+        static void setCpuMhz(uint32_t mhz);
+
+        static inline uint32_t now() {
+#ifdef NATIVE
+            return micros();
+#else
+            return ESP.getCycleCount();
+#endif
+        }
+        static inline uint32_t toMicros(uint32_t cycles) { return cycles / cyclesPerUs; }
+
+        static void record(ProfilePoint point, uint32_t us);
+        static void recordFrame(unsigned long dt, unsigned long interval);
+
+        // Copy the statistics since the last snapshot and reset them
+        static void snapshot(ProfileSnapshot& target);
+
+        static const char* name(ProfilePoint point);
+};
+
+// Records the lifetime of the object as one sample of point
+class ScopedTimer {
+    private:
+        ProfilePoint point;
+        uint32_t start;
+
+    public:
+        ScopedTimer(ProfilePoint point) : point(point), start(Profiler::now()) {}
+        ~ScopedTimer() { Profiler::record(point, Profiler::toMicros(Profiler::now() - start)); }
+};
+
+#if ENABLE_PROFILING
+#define PROFILE_SCOPE(point) ScopedTimer profileScope(point)
+#define PROFILE_FRAME(dt, interval) Profiler::recordFrame(dt, interval)
+#else
+#define PROFILE_SCOPE(point)
+#define PROFILE_FRAME(dt, interval)
+#endif
+
+#endif // PROFILER_HPP
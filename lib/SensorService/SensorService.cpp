@@ -1,48 +1,153 @@
 #include "SensorService.hpp"
 
+#ifndef NATIVE
+#include "GpioSensorInput.hpp"
+#endif
+
+// The ring buffer is written from the ISR and from loop(), guard both writers
+#ifdef ESP32
+static portMUX_TYPE sensorMux = portMUX_INITIALIZER_UNLOCKED;
+#define SENSOR_ENTER_CRITICAL()     portENTER_CRITICAL(&sensorMux)
+#define SENSOR_EXIT_CRITICAL()      portEXIT_CRITICAL(&sensorMux)
+#define SENSOR_ENTER_CRITICAL_ISR() portENTER_CRITICAL_ISR(&sensorMux)
+#define SENSOR_EXIT_CRITICAL_ISR()  portEXIT_CRITICAL_ISR(&sensorMux)
+#else
+#define SENSOR_ENTER_CRITICAL()     noInterrupts()
+#define SENSOR_EXIT_CRITICAL()      interrupts()
+#define SENSOR_ENTER_CRITICAL_ISR()
+#define SENSOR_EXIT_CRITICAL_ISR()
+#endif
+
+SensorService* SensorService::instance = nullptr;
+EdgeNotifier SensorService::edgeNotifier = nullptr;
+
+#ifndef NATIVE
+// There is only one sensor, GpioSensorInput keeps its ISR state static anyway
+static SensorInput* gpioSensorInput(uint8_t pin) {
+    static GpioSensorInput input(pin);
+    return &input;
+}
+
+SensorService::SensorService(uint8_t pin)
+    : SensorService(gpioSensorInput(pin)) {
+}
+#endif
+
 void SensorService::setup() {
-    pinMode(sensorPin, INPUT_PULLUP);
-    sensorState = digitalRead(sensorPin);
+    input->begin();
+    sensorState = input->read();
     lastSensorState = sensorState;
-    risingEdgeDetected = false;
-    fallingEdgeDetected = false;
-    Serial.println("[INFO] SensorService initialized");
+    edgeHead = 0;
+    edgeTail = 0;
+    droppedEdges = 0;
+    lastEdgeUs = micros();
+
+#if SENSOR_USE_INTERRUPT
+    instance = this;
+    interruptMode = input->attachChangeHandler(handleLevelChange);
+#endif
+
+    Serial.print("[INFO] SensorService initialized (");
+    Serial.print(interruptMode ? "interrupt" : "polling");
+    Serial.println(" mode)");
 }
 
-void SensorService::loop() {
-    // Update sensor state and detect edges
+void IRAM_ATTR SensorService::handleLevelChange(uint8_t level) {
+    if (instance) {
+        SENSOR_ENTER_CRITICAL_ISR();
+        instance->captureLevel(level);
+        SENSOR_EXIT_CRITICAL_ISR();
+        
+        // E.g. wake a loop() that sleeps until the next frame
+        if (edgeNotifier) {
+            edgeNotifier();
+        }
+    }
+}
+
+void IRAM_ATTR SensorService::captureLevel(uint8_t level) {
+    // Ignore glitches that end on the level we already reported
+    if (level == sensorState) {
+        return;
+    }
+    
+    // Debounce: contact bounce right after an accepted edge is dropped
+    uint32_t nowUs = micros();
+    if (nowUs - lastEdgeUs < debounceUs) {
+        return;
+    }
+    
+    lastEdgeUs = nowUs;
     lastSensorState = sensorState;
-    sensorState = digitalRead(sensorPin);
+    sensorState = level;
     
-    // Detect rising edge (HIGH to LOW for TCRT5000 - donation detected)
-    if (lastSensorState == HIGH && sensorState == LOW) {
-        risingEdgeDetected = true;
-        Serial.println("[SENSOR] Rising edge detected - donation placed");
+    uint8_t next = (edgeHead + 1) % SENSOR_EDGE_BUFFER_SIZE;
+    if (next == edgeTail) {
+        droppedEdges++;
+        return;
     }
     
-    // Detect falling edge (LOW to HIGH for TCRT5000 - donation removed)
-    if (lastSensorState == LOW && sensorState == HIGH) {
-        fallingEdgeDetected = true;
+    // HIGH to LOW for TCRT5000 = donation detected
+    edges[edgeHead].timestampUs = nowUs;
+    edges[edgeHead].timestampMs = millis();
+    edges[edgeHead].rising = (level == LOW);
+    edgeHead = next;
+}
+
+void SensorService::loop() {
+    uint8_t level = input->read();
+    
+    // Polling fallback, and in interrupt mode catch a final level change that
+    // was swallowed by the debounce window with no edge following it
+    if (level != sensorState && micros() - lastEdgeUs >= debounceUs) {
+        SENSOR_ENTER_CRITICAL();
+        captureLevel(level);
+        SENSOR_EXIT_CRITICAL();
+    }
+}
+
+bool SensorService::popEdge(SensorEdge& edge) {
+    if (edgeTail == edgeHead) {
+        return false;
+    }
+    
+    edge = edges[edgeTail];
+    edgeTail = (edgeTail + 1) % SENSOR_EDGE_BUFFER_SIZE;
+    
+    if (edge.rising) {
+        Serial.println("[SENSOR] Rising edge detected - donation placed");
+    } else {
         Serial.println("[SENSOR] Falling edge detected - donation removed");
     }
+    return true;
+}
+
+uint8_t SensorService::pendingEdges() const {
+    return (edgeHead + SENSOR_EDGE_BUFFER_SIZE - edgeTail) % SENSOR_EDGE_BUFFER_SIZE;
 }
 
 bool SensorService::risingEdge() {
-    if (risingEdgeDetected) {
-        risingEdgeDetected = false; // Reset flag after reading
-        return true;
+    // Consumes buffered edges up to and including the next rising one
+    SensorEdge edge;
+    while (popEdge(edge)) {
+        if (edge.rising) {
+            return true;
+        }
     }
     return false;
 }
 
 bool SensorService::fallingEdge() {
-    if (fallingEdgeDetected) {
-        fallingEdgeDetected = false; // Reset flag after reading
-        return true;
+    // Consumes buffered edges up to and including the next falling one
+    SensorEdge edge;
+    while (popEdge(edge)) {
+        if (!edge.rising) {
+            return true;
+        }
     }
     return false;
 }
 
 bool SensorService::isActive() {
-    return digitalRead(sensorPin) == LOW; // LOW means donation detected
+    return input->read() == LOW; // LOW means donation detected
 }
@@ -4,24 +4,60 @@
 #include <Arduino.h>
 
 #include "Config.h"
+#include "SensorInput.hpp"
+
+// A single debounced sensor transition, timestamped when it happened
+struct SensorEdge {
+    uint32_t timestampUs; // micros() at capture time
+    uint32_t timestampMs; // millis() at capture time
+    bool rising;          // true = donation placed (HIGH -> LOW), false = removed
+};
+
+// Called from the GPIO interrupt after an edge was captured, must be IRAM_ATTR
+typedef void (*EdgeNotifier)();
 
 class SensorService {
     private:
-        uint8_t sensorPin;
+        SensorInput* input;
         uint8_t sensorState = HIGH;
         uint8_t lastSensorState = HIGH;
-        bool risingEdgeDetected = false;
-        bool fallingEdgeDetected = false;
+
+        // Edge ring buffer, filled by the ISR (or loop() when polling) and drained by popEdge()
+        SensorEdge edges[SENSOR_EDGE_BUFFER_SIZE];
+        volatile uint8_t edgeHead = 0;
+        volatile uint8_t edgeTail = 0;
+        volatile uint16_t droppedEdges = 0;
+        volatile uint32_t lastEdgeUs = 0;
+        uint32_t debounceUs = SENSOR_DEBOUNCE_MS * 1000UL;
+        bool interruptMode = false;
+
+        static SensorService* instance;
+        static EdgeNotifier edgeNotifier;
+        static void IRAM_ATTR handleLevelChange(uint8_t level);
+
+        void IRAM_ATTR captureLevel(uint8_t level);
 
     public:
-        SensorService(uint8_t pin) : sensorPin(pin), sensorState(HIGH), lastSensorState(HIGH) {}
+#ifndef NATIVE
+        // TCRT5000 on a GPIO
+        SensorService(uint8_t pin);
+#endif
+        SensorService(SensorInput* input) : input(input), sensorState(HIGH), lastSensorState(HIGH) {}
+
+        bool popEdge(SensorEdge& edge);
+        uint8_t pendingEdges() const;
+        uint16_t getDroppedEdges() const { return droppedEdges; }
 
         bool risingEdge();
         bool fallingEdge();
         bool isActive();
 
+        void setDebounce(uint16_t ms) { debounceUs = ms * 1000UL; }
+        void setEdgeNotifier(EdgeNotifier notifier) { edgeNotifier = notifier; }
+        bool isInterruptMode() const { return interruptMode; }
+
         void setup();
         void loop();
 };
 
-#endif // SENSOR_SERVICE_HPP
\ No newline at end of file
+#endif // SENSOR_SERVICE_HPP
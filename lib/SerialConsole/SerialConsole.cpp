@@ -0,0 +1,59 @@
+#include "SerialConsole.hpp"
+
+bool SerialConsole::addCommand(const char* name, const char* help, CommandHandler handler) {
+    if (commandCount >= CONSOLE_MAX_COMMANDS) {
+        return false;
+    }
+    commands[commandCount++] = {name, help, handler};
+    return true;
+}
+
+void SerialConsole::loop() {
+    while (stream.available() > 0) {
+        int c = stream.read();
+        if (c < 0) {
+            return;
+        }
+
+        if (c == '\r' || c == '\n') {
+            if (overflow) {
+                stream.println("[CONSOLE] Line too long");
+            } else if (lineLength > 0) {
+                line[lineLength] = '\0';
+                dispatch();
+            }
+            lineLength = 0;
+            overflow = false;
+        } else if (lineLength < CONSOLE_LINE_LENGTH - 1) {
+            line[lineLength++] = (char)c;
+        } else {
+            overflow = true;
+        }
+    }
+}
+
+void SerialConsole::dispatch() {
+    if (strcmp(line, "help") == 0) {
+        printHelp();
+        return;
+    }
+
+    for (uint8_t i = 0; i < commandCount; i++) {
+        if (strcmp(line, commands[i].name) == 0) {
+            commands[i].handler(stream);
+            return;
+        }
+    }
+
+    stream.print("[CONSOLE] Unknown command: ");
+    stream.println(line);
+    printHelp();
+}
+
+void SerialConsole::printHelp() {
+    stream.println("[CONSOLE] Commands:");
+    for (uint8_t i = 0; i < commandCount; i++) {
+        stream.printf("  %-8s %s\n", commands[i].name, commands[i].help);
+    }
+    stream.println("  help     This list");
+}
@@ -0,0 +1,44 @@
+#ifndef SERIAL_CONSOLE_HPP
+#define SERIAL_CONSOLE_HPP
+
+#include <Arduino.h>
+#include "Config.h"
+
+#define CONSOLE_MAX_COMMANDS 8  // Registered commands
+#define CONSOLE_LINE_LENGTH  32 // Longest accepted input line incl. terminator
+
+/**
+ * SerialConsole - line-based debug commands on the serial port
+ * loop() reads whatever bytes are available without waiting and runs the
+ * matching handler once a line is complete. No heap is used.
+ */
+class SerialConsole {
+    public:
+        typedef void (*CommandHandler)(Print& out);
+
+    private:
+        struct Command {
+            const char* name;
+            const char* help;
+            CommandHandler handler;
+        };
+
+        Stream& stream;
+        Command commands[CONSOLE_MAX_COMMANDS];
+        uint8_t commandCount = 0;
+        char line[CONSOLE_LINE_LENGTH];
+        uint8_t lineLength = 0;
+        bool overflow = false;
+
+        void dispatch();
+        void printHelp();
+
+    public:
+        SerialConsole(Stream& stream) : stream(stream) {}
+
+        // name and help must stay valid (string literals)
+        bool addCommand(const char* name, const char* help, CommandHandler handler);
+        void loop();
+};
+
+#endif // SERIAL_CONSOLE_HPP
@@ -1,187 +1,264 @@
 #include "SpeakerService.hpp"
 
-SpeakerService::SpeakerService() : 
+#ifndef NATIVE
+#include "DfPlayerAudio.hpp"
+#endif
+
+// Optional measured clip lengths, see include/SoundTable.h.example
+#ifdef __has_include
+  #if __has_include("SoundTable.h")
+    #include "SoundTable.h"
+  #endif
+#endif
+
+#ifdef SOUND_TABLE
+static const SoundEnvelope soundTable[] PROGMEM = {SOUND_TABLE};
+static const uint16_t SOUND_TABLE_SIZE = sizeof(soundTable) / sizeof(soundTable[0]);
+#endif
+
+SpeakerService::SpeakerService(AudioPlayer* player) : 
+    player(player),
     isInitialized(false), 
     isHardwareAvailable(false), 
     currentVolume(DFPLAYER_VOLUME)
 {
-#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))
-    softSerial = new SoftwareSerial(DFPLAYER_RX, DFPLAYER_TX);
-#endif
-}
-
-SpeakerService::~SpeakerService() {
-#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))
-    if (softSerial) {
-        delete softSerial;
-        softSerial = nullptr;
+#ifndef NATIVE
+    if (!this->player) {
+        static DfPlayerAudio defaultPlayer;
+        this->player = &defaultPlayer;
     }
 #endif
 }
 
 bool SpeakerService::setup() {
-    if (isInitialized) {
+    if (isInitialized || initState != INIT_IDLE) {
         return isHardwareAvailable;
     }
 
-    // Check boot counter to avoid infinite restart loops
-    static int bootAttempts = 0;
-    bootAttempts++;
-
-    delay(3000); // Wait for 3 seconds to allow hardware to stabilize
+    // Initialization continues in loop(), the rest of the system keeps running
+    initState = INIT_POWER_UP;
+    initStarted = millis();
 
 #if ENABLE_SERIAL_DEBUG
-    Serial.println(F("[SpeakerService] Initializing DFPlayer Mini..."));
-    Serial.print(F("[SpeakerService] Boot attempt: "));
-    Serial.println(bootAttempts);
-    Serial.println(F("[SpeakerService] (May take 3~5 seconds)"));
+    Serial.println(F("[SpeakerService] Initializing DFPlayer Mini in background..."));
 #endif
 
-#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))
-    if (!softSerial) {
-        return false;
-    }
-    softSerial->begin(DFPLAYER_BAUD_RATE);
+    return true;
+}
+
+void SpeakerService::advanceInit() {
+    unsigned long now = millis();
     
-    // Initialize DFPlayer with software serial - exactly like the example
-    if (!myDFPlayer.begin(*softSerial, /*isACK = */true, /*doReset = */false)) {
+    switch (initState) {
+        case INIT_IDLE:
+            break;
+            
+        case INIT_POWER_UP:
+            // Give the module time to power up (and wait between retries)
+            if (now - initStarted < DFPLAYER_STARTUP_DELAY) {
+                break;
+            }
+            
+            beginAttempts++;
+            if (player->begin()) {
 #if ENABLE_SERIAL_DEBUG
-        Serial.println(F("[SpeakerService] Unable to begin:"));
-        Serial.println(F("[SpeakerService] 1.Please recheck the connection!"));
-        Serial.println(F("[SpeakerService] 2.Please insert the SD card!"));
-        
-        if (bootAttempts < 3) {
-            Serial.println(F("[SpeakerService] Restarting in 10 seconds..."));
-        } else {
-            Serial.println(F("[SpeakerService] Too many attempts, continuing without DFPlayer..."));
-        }
+                Serial.println(F("[SpeakerService] DFPlayer Mini online."));
 #endif
-        
-        if (bootAttempts < 3) {
-            // Wait for 10 seconds then restart - like the example but with timeout
-            unsigned long startTime = millis();
-            while(millis() - startTime < 10000) { // 10 second timeout
-                delay(0); // Code to compatible with ESP8266 watch dog.
+                initState = INIT_WAIT_READY;
+                initStarted = now;
+                break;
             }
-            // Force restart after timeout
-            ESP.restart();
-        } else {
-            // After 3 attempts, continue without DFPlayer
-            isInitialized = true;
-            isHardwareAvailable = false;
-            return false;
-        }
-    }
-    
-#elif defined(ESP32)
-    // ESP32 hardware serial configuration
-    Serial1.begin(DFPLAYER_BAUD_RATE, SERIAL_8N1, DFPLAYER_RX, DFPLAYER_TX);
-    
-    // Initialize DFPlayer with hardware serial
-    if (!myDFPlayer.begin(Serial1, /*isACK = */true, /*doReset = */false)) {
+
 #if ENABLE_SERIAL_DEBUG
-        Serial.println(F("[SpeakerService] Unable to begin:"));
-        Serial.println(F("[SpeakerService] 1.Please recheck the connection!"));
-        Serial.println(F("[SpeakerService] 2.Please insert the SD card!"));
-        
-        if (bootAttempts < 3) {
-            Serial.println(F("[SpeakerService] Restarting in 10 seconds..."));
-        } else {
-            Serial.println(F("[SpeakerService] Too many attempts, continuing without DFPlayer..."));
-        }
+            Serial.println(F("[SpeakerService] Unable to begin:"));
+            Serial.println(F("[SpeakerService] 1.Please recheck the connection!"));
+            Serial.println(F("[SpeakerService] 2.Please insert the SD card!"));
+#endif
+            
+            if (beginAttempts < DFPLAYER_RETRY) {
+                // Try again later instead of restarting the whole box
+                initStarted = now;
+            } else {
+#if ENABLE_SERIAL_DEBUG
+                Serial.println(F("[SpeakerService] Too many attempts, continuing without DFPlayer..."));
 #endif
-        
-        if (bootAttempts < 3) {
-            // Wait for 10 seconds then restart - like the example but with timeout
-            unsigned long startTime = millis();
-            while(millis() - startTime < 10000) { // 10 second timeout
-                delay(0); // Code to compatible with ESP32 watch dog.
+                initState = INIT_IDLE;
+                isInitialized = true;
+                isHardwareAvailable = false;
+            }
+            break;
+            
+        case INIT_WAIT_READY:
+            // Wait for the first message (card online), but not forever
+            if (!player->available() && now - initStarted < DFPLAYER_READY_TIMEOUT) {
+                break;
+            }
+            
+#if ENABLE_SERIAL_DEBUG
+            if (now - initStarted >= DFPLAYER_READY_TIMEOUT) {
+                Serial.println(F("[SpeakerService] No ready message, continuing anyway"));
             }
-            // Force restart after timeout
-            ESP.restart();
-        } else {
-            // After 3 attempts, continue without DFPlayer
+            Serial.print(F("[SpeakerService] DFPlayer Mini is ready after "));
+            Serial.print(now);
+            Serial.println(F(" ms"));
+#endif
+
+            initState = INIT_IDLE;
             isInitialized = true;
-            isHardwareAvailable = false;
-            return false;
-        }
+            isHardwareAvailable = true;
+            player->setTimeOut(DFPLAYER_TIMEOUT);
+
+            // Set default volume - like in the example
+            // (queued directly, this already runs on the loop() side)
+            queueCommand(CMD_VOLUME, currentVolume);
+            queueCommand(CMD_PLAY, STARTUP_SOUND_FILE);
+            break;
+    }
+}
+
+void SpeakerService::loop() {
+    if (initState != INIT_IDLE) {
+        advanceInit();
+        return;
     }
     
-#else
-    // Default hardware serial
-    Serial1.begin(DFPLAYER_BAUD_RATE);
+    if (!isReady()) {
+        return;
+    }
+    
+#if ENABLE_DUAL_CORE
+    // Take over commands queued on the render core
+    Command incoming;
+    while (inbox.pop(incoming)) {
+        queueCommand(incoming.type, incoming.argument);
+    }
+#endif
     
-    if (!myDFPlayer.begin(Serial1, /*isACK = */true, /*doReset = */true)) {
+    // Check for DFPlayer messages/errors (also consumes command ACKs)
+    if (player->available()) {
+        handleMessage(player->readType(), player->read());
+    }
+    
+    processQueue();
+}
+
+void SpeakerService::enqueue(CommandType type, uint16_t argument) {
+#if ENABLE_DUAL_CORE
+    Command command = {type, argument, 0};
+    if (!inbox.push(command)) {
 #if ENABLE_SERIAL_DEBUG
-        Serial.println(F("[SpeakerService] Unable to begin:"));
-        Serial.println(F("[SpeakerService] 1.Please recheck the connection!"));
-        Serial.println(F("[SpeakerService] 2.Please insert the SD card!"));
-        
-        if (bootAttempts < 3) {
-            Serial.println(F("[SpeakerService] Restarting in 10 seconds..."));
-        } else {
-            Serial.println(F("[SpeakerService] Too many attempts, continuing without DFPlayer..."));
-        }
+        Serial.println(F("[SpeakerService] Command inbox full, command dropped"));
 #endif
-        
-        if (bootAttempts < 3) {
-            // Wait for 10 seconds then restart - like the example but with timeout
-            unsigned long startTime = millis();
-            while(millis() - startTime < 10000) { // 10 second timeout
-                delay(0); // Code to compatible with watch dog.
-            }
-            // Force restart after timeout
-            ESP.restart();
-        } else {
-            // After 3 attempts, continue without DFPlayer
-            isInitialized = true;
-            isHardwareAvailable = false;
-            return false;
-        }
     }
+#else
+    queueCommand(type, argument);
 #endif
+}
 
+void SpeakerService::queueCommand(CommandType type, uint16_t argument) {
+    // Coalesce: a newer volume or track request replaces a pending one
+    // (but never one queued before a reset, the reset would discard it)
+    if (type == CMD_VOLUME || type == CMD_PLAY) {
+        for (uint8_t i = queueCount; i-- > 0;) {
+            Command& pending = queue[(queueHead + i) % DFPLAYER_QUEUE_SIZE];
+            if (pending.type == CMD_RESET) {
+                break;
+            }
+            if (pending.type == type) {
+                pending.argument = argument;
+                pending.retries = 0;
+                return;
+            }
+        }
+    }
+    
+    if (queueCount == DFPLAYER_QUEUE_SIZE) {
 #if ENABLE_SERIAL_DEBUG
-    Serial.println(F("[SpeakerService] DFPlayer Mini online."));
+        Serial.println(F("[SpeakerService] Command queue full, command dropped"));
 #endif
-
-    while(!this->myDFPlayer.available()) {
-        // Wait for DFPlayer to be ready
-        delay(100);
-        Serial.print(F("."));
+        return;
     }
+    
+    Command& command = queue[(queueHead + queueCount) % DFPLAYER_QUEUE_SIZE];
+    command.type = type;
+    command.argument = argument;
+    command.retries = 0;
+    queueCount++;
+}
 
-    Serial.println(F("[SpeakerService] DFPlayer Mini is ready."));
-
-    isInitialized = true;
-    isHardwareAvailable = true;
-
-    // Set default volume - like in the example
-    setVolume(currentVolume);
+void SpeakerService::requeueFront(const Command& command) {
+    if (queueCount == DFPLAYER_QUEUE_SIZE) {
+        return;
+    }
+    queueHead = (queueHead + DFPLAYER_QUEUE_SIZE - 1) % DFPLAYER_QUEUE_SIZE;
+    queue[queueHead] = command;
+    queueCount++;
+}
 
-    this->playStartupSound();
+void SpeakerService::processQueue() {
+    if (queueCount == 0 || millis() - lastSendTime < sendGap) {
+        return;
+    }
     
-    return true;
+    Command command = queue[queueHead];
+    queueHead = (queueHead + 1) % DFPLAYER_QUEUE_SIZE;
+    queueCount--;
+    
+    sendCommand(command);
 }
 
-void SpeakerService::loop() {
-    if (!isReady()) {
-        return;
+void SpeakerService::sendCommand(const Command& command) {
+    switch (command.type) {
+        case CMD_PLAY:     player->play(command.argument); break;
+        case CMD_VOLUME:   player->volume(command.argument); break;
+        case CMD_PAUSE:    player->pause(); break;
+        case CMD_RESUME:   player->start(); break;
+        case CMD_STOP:     player->stop(); break;
+        case CMD_NEXT:     player->next(); break;
+        case CMD_PREVIOUS: player->previous(); break;
+        case CMD_RESET:    player->reset(); break;
     }
     
-    // Check for DFPlayer messages/errors
-    if (myDFPlayer.available()) {
-        printDetail(myDFPlayer.readType(), myDFPlayer.read());
+    lastCommand = command;
+    commandInFlight = true;
+    lastSendTime = millis();
+    // The module is deaf while it resets
+    sendGap = command.type == CMD_RESET ? DFPLAYER_RESET_TIME : DFPLAYER_COMMAND_GAP;
+}
+
+void SpeakerService::handleMessage(uint8_t type, int value) {
+    // Retry the last command on transmission problems
+    bool transmissionError = type == TimeOut ||
+        (type == DFPlayerError && (value == SerialWrongStack || value == CheckSumNotMatch));
+    
+    if (transmissionError && commandInFlight) {
+        if (type == TimeOut) {
+            timeoutCount++;
+        }
+        if (lastCommand.retries < DFPLAYER_RETRY) {
+            Command retry = lastCommand;
+            retry.retries++;
+            requeueFront(retry);
+        }
+    } else if (type == DFPlayerPlayFinished) {
+        // Ends the light effect of the donation that played this track
+        finishedTracks.push(value);
+    } else if (type == DFPlayerError && commandInFlight && lastCommand.type == CMD_PLAY) {
+        // Missing file or card: nothing plays, so nothing will finish either
+        finishedTracks.push(lastCommand.argument);
     }
+    commandInFlight = false;
+    
+    printDetail(type, value);
 }
 
 bool SpeakerService::isReady() const {
     return isInitialized && isHardwareAvailable;
 }
 
-void SpeakerService::playRandomSound() {
+uint16_t SpeakerService::playRandomSound() {
     if (!isReady()) {
-        return;
+        return 0;
     }
     
     // Generate random track number between DONATION_SOUND_BASE and DONATION_SOUND_BASE + DONATION_SOUND_COUNT - 1
@@ -192,6 +269,7 @@ void SpeakerService::playRandomSound() {
     Serial.print(F("[SpeakerService] Playing random sound: "));
     Serial.println(randomTrack);
 #endif
+    return randomTrack;
 }
 
 void SpeakerService::playSound(const String& soundFile) {
@@ -211,8 +289,23 @@ void SpeakerService::playSound(const String& soundFile) {
 #endif
 }
 
-void SpeakerService::playDonationSound() {
-    playRandomSound();
+uint16_t SpeakerService::playDonationSound() {
+    return playRandomSound();
+}
+
+bool SpeakerService::getSound(uint16_t track, SoundEnvelope& sound) {
+#ifdef SOUND_TABLE
+    // Entry 0 is 001.mp3
+    if (track == 0 || track > SOUND_TABLE_SIZE) {
+        return false;
+    }
+    memcpy_P(&sound, &soundTable[track - 1], sizeof(sound));
+    return sound.durationMs > 0;
+#else
+    (void)track;
+    (void)sound;
+    return false;
+#endif
 }
 
 void SpeakerService::playStartupSound() {
@@ -235,7 +328,7 @@ void SpeakerService::setVolume(uint8_t volume) {
     // Constrain volume to valid range (0-30 for DFPlayer Mini)
     volume = constrain(volume, 0, 30);
     currentVolume = volume;
-    myDFPlayer.volume(volume);
+    enqueue(CMD_VOLUME, volume);
     
 #if ENABLE_SERIAL_DEBUG
     Serial.print(F("[SpeakerService] Volume set to: "));
@@ -264,7 +357,7 @@ bool SpeakerService::playTrack(int trackNumber) {
         return false;
     }
     
-    myDFPlayer.play(trackNumber);
+    enqueue(CMD_PLAY, trackNumber);
     
 #if ENABLE_SERIAL_DEBUG
     Serial.print(F("[SpeakerService] Playing track: "));
@@ -279,7 +372,7 @@ void SpeakerService::pause() {
         return;
     }
     
-    myDFPlayer.pause();
+    enqueue(CMD_PAUSE);
     
 #if ENABLE_SERIAL_DEBUG
     Serial.println(F("[SpeakerService] Paused"));
@@ -291,7 +384,7 @@ void SpeakerService::resume() {
         return;
     }
     
-    myDFPlayer.start();
+    enqueue(CMD_RESUME);
     
 #if ENABLE_SERIAL_DEBUG
     Serial.println(F("[SpeakerService] Resumed"));
@@ -303,7 +396,7 @@ void SpeakerService::stop() {
         return;
     }
     
-    myDFPlayer.stop();
+    enqueue(CMD_STOP);
     
 #if ENABLE_SERIAL_DEBUG
     Serial.println(F("[SpeakerService] Stopped"));
@@ -315,7 +408,7 @@ bool SpeakerService::next() {
         return false;
     }
     
-    myDFPlayer.next();
+    enqueue(CMD_NEXT);
     
 #if ENABLE_SERIAL_DEBUG
     Serial.println(F("[SpeakerService] Next track"));
@@ -329,7 +422,7 @@ bool SpeakerService::previous() {
         return false;
     }
     
-    myDFPlayer.previous();
+    enqueue(CMD_PREVIOUS);
     
 #if ENABLE_SERIAL_DEBUG
     Serial.println(F("[SpeakerService] Previous track"));
@@ -360,16 +453,13 @@ void SpeakerService::reset() {
         return;
     }
     
-    myDFPlayer.reset();
+    enqueue(CMD_RESET);
     
 #if ENABLE_SERIAL_DEBUG
     Serial.println(F("[SpeakerService] Reset"));
 #endif
     
-    // Give some time for reset to complete
-    delay(1000);
-    
-    // Restore volume after reset
+    // Restore volume after reset (sent once DFPLAYER_RESET_TIME has passed)
     setVolume(currentVolume);
 }
 
@@ -4,41 +4,106 @@
 #include <Arduino.h>
 #include "Config.h"
 #include "DFRobotDFPlayerMini.h"
+#include "AudioPlayer.hpp"
+#include "SpscQueue.hpp"
 
-#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))   // Using a soft serial port
-#include <SoftwareSerial.h>
-#endif
+// Length and loudness of one MP3 file, see include/SoundTable.h.example
+struct SoundEnvelope {
+    uint16_t durationMs;
+    uint8_t levels[SOUND_ENVELOPE_POINTS]; // Loudness at evenly spaced points, 255 = loudest
+};
 
 /**
  * Speaker Service - DFPlayer Mini MP3 Player
  * Based on working DFRobot example code
+ *
+ * setup() returns immediately, the DFPlayer is brought up from loop()
+ * while the lights already run. Commands are queued and sent one at a
+ * time from loop(), so callers (e.g. a mode's donationTriggered()) never
+ * wait on the serial link
+ *
+ * With ENABLE_DUAL_CORE the public methods are called from the render
+ * core and loop() runs on the I/O core; commands cross over through a
+ * lock-free inbox, playback-finished messages come back the same way
  */
 class SpeakerService {
     private:
-#if (defined(ARDUINO_AVR_UNO) || defined(ESP8266))
-        SoftwareSerial* softSerial;
-#endif
-        DFRobotDFPlayerMini myDFPlayer;
+        enum InitState : uint8_t {
+            INIT_IDLE,        // Not started or finished
+            INIT_POWER_UP,    // Waiting for the module to power up
+            INIT_WAIT_READY   // Waiting for the card-online message
+        };
+
+        enum CommandType : uint8_t {
+            CMD_PLAY,
+            CMD_VOLUME,
+            CMD_PAUSE,
+            CMD_RESUME,
+            CMD_STOP,
+            CMD_NEXT,
+            CMD_PREVIOUS,
+            CMD_RESET
+        };
+
+        struct Command {
+            CommandType type;
+            uint16_t argument;
+            uint8_t retries;
+        };
+
+        AudioPlayer* player;
         bool isInitialized;
         bool isHardwareAvailable;
         uint8_t currentVolume = DFPLAYER_VOLUME; // Default volume level
+
+        // Background initialization (driven by loop())
+        InitState initState = INIT_IDLE;
+        unsigned long initStarted = 0;
+        uint8_t beginAttempts = 0;
+
+        // Command queue (ring buffer, oldest at queueHead)
+        Command queue[DFPLAYER_QUEUE_SIZE];
+        uint8_t queueHead = 0;
+        uint8_t queueCount = 0;
+        Command lastCommand;
+        bool commandInFlight = false;
+        unsigned long lastSendTime = 0;
+        unsigned long sendGap = DFPLAYER_COMMAND_GAP;
+        uint16_t timeoutCount = 0;
+#if ENABLE_DUAL_CORE
+        SpscQueue<Command, DFPLAYER_QUEUE_SIZE> inbox; // Render core -> I/O core
+#endif
+        SpscQueue<uint16_t, 4> finishedTracks;         // loop() -> render side
         
+        void advanceInit();
+        void enqueue(CommandType type, uint16_t argument = 0);
+        void queueCommand(CommandType type, uint16_t argument);
+        void requeueFront(const Command& command);
+        void processQueue();
+        void sendCommand(const Command& command);
+        void handleMessage(uint8_t type, int value);
         void printDetail(uint8_t type, int value);
         
     public:
-        SpeakerService();
-        ~SpeakerService();
+        // Uses the DFPlayer Mini on the board when player is nullptr
+        SpeakerService(AudioPlayer* player = nullptr); // player is not owned
 
         // Core functionality
         bool setup();
         void loop();
         bool isReady() const;
+        bool isStarting() const { return initState != INIT_IDLE; }
         
-        // High-level audio methods
-        void playRandomSound();
+        // High-level audio methods, the random ones return the track (0 = nothing played)
+        uint16_t playRandomSound();
         void playSound(const String& soundFile);
-        void playDonationSound();
+        uint16_t playDonationSound();
         void playStartupSound();
+
+        // Length and envelope from SoundTable.h, false if the track is not listed
+        static bool getSound(uint16_t track, SoundEnvelope& sound);
+        // Tracks the DFPlayer reported as finished (or unplayable), render side
+        bool popFinished(uint16_t& track) { return finishedTracks.pop(track); }
         
         // Volume control
         void setVolume(uint8_t volume);
@@ -58,6 +123,8 @@ class SpeakerService {
         
         // Status
         bool isPlaying();
+        uint8_t getPendingCommands() const { return queueCount; }
+        uint16_t getTimeoutCount() const { return timeoutCount; }
         
         // Configuration
         void enableDebug(bool enable = true);
@@ -0,0 +1,56 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * SPSC Queue - lock-free single-producer/single-consumer ring buffer
+ * Hands data from one core (or task) to another without a mutex.
+ * Exactly one context may call push() and exactly one may call pop().
+ */
+template <typename T, uint16_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+    private:
+        T items[Capacity];
+        // Free-running counters, the index is counter % Capacity
+        std::atomic<uint16_t> head{0}; // Written by the consumer only
+        std::atomic<uint16_t> tail{0}; // Written by the producer only
+        std::atomic<uint16_t> dropped{0};
+
+    public:
+        // Producer side, returns false if the queue is full
+        bool push(const T& item) {
+            uint16_t currentTail = tail.load(std::memory_order_relaxed);
+            if ((uint16_t)(currentTail - head.load(std::memory_order_acquire)) >= Capacity) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            items[currentTail % Capacity] = item;
+            tail.store(currentTail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side, returns false if the queue is empty
+        bool pop(T& item) {
+            uint16_t currentHead = head.load(std::memory_order_relaxed);
+            if (currentHead == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = items[currentHead % Capacity];
+            head.store(currentHead + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Approximate when called from the other side
+        uint16_t size() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+        bool isEmpty() const { return size() == 0; }
+        uint16_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+#endif // SPSC_QUEUE_HPP
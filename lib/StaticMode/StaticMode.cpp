@@ -2,12 +2,23 @@
 #include "Config.h"
 #include <Arduino.h>
 
+static const char staticModeDescription[] PROGMEM = "Gentle breathing effect with white LEDs";
+static const char staticModeAuthor[] PROGMEM = "Friedjof";
+static const char staticModeVersion[] PROGMEM = "v1.0.0";
+static const ModeInfo staticModeInfo = {"Static Breathing", staticModeDescription, staticModeAuthor, staticModeVersion};
+
 StaticMode::StaticMode(LightService* lightService, SpeakerService* speakerService) 
-    : AbstractMode(lightService, speakerService, 
-                  "Static Breathing", 
-                  "Gentle breathing effect with white LEDs", 
-                  "Friedjof", 
-                  "v1.0.0") {
+    : AbstractMode(lightService, speakerService, staticModeInfo) {
+    buildBreathTable();
+}
+
+void StaticMode::buildBreathTable() {
+    // Triangle wave: up in BRIGHTNESS_STEP increments, then back down
+    for (uint16_t i = 0; i < BREATH_STEPS; i++) {
+        uint16_t distance = i <= RAMP_STEPS ? i : BREATH_STEPS - i;
+        uint16_t brightness = MIN_BRIGHTNESS + distance * BRIGHTNESS_STEP;
+        breathTable[i] = brightness > MAX_BRIGHTNESS ? MAX_BRIGHTNESS : brightness;
+    }
 }
 
 void StaticMode::setup() {
@@ -19,11 +30,8 @@ void StaticMode::setup() {
     // Set effect duration for StaticMode
     effectDuration = 3000; // 3 seconds
     
-    currentBrightness = MIN_BRIGHTNESS;
-    newBrightness = MIN_BRIGHTNESS;
-    direction = 1;
+    phase = 0;
     speed = BREATH_SPEED_NORMAL;
-    lastUpdate = millis();
 }
 
 void StaticMode::donationTriggered() {
@@ -35,45 +43,30 @@ void StaticMode::donationTriggered() {
     // Speed up breathing effect
     speed = BREATH_SPEED_FAST;
     
-    // Play sound
-    speakerService->playDonationSound();
+    // Play sound, the effect lasts as long as the clip
+    startDonationSound();
 }
 
-void StaticMode::loop() {
-    unsigned long currentTime = millis();
-    
+void StaticMode::renderFrame(unsigned long now, unsigned long dt) {
     // Check if donation effect should end
-    if (effectActive && currentTime - effectStartTime >= effectDuration) {
+    if (donationEffectDone(now)) {
         endDonationEffect();
         speed = BREATH_SPEED_NORMAL;
         Serial.println("[INFO] StaticMode donation effect ended - mode will deactivate");
     }
     
     // Breathing effect timing
-    if (currentTime - lastUpdate >= speed) {
-        lastUpdate = currentTime;
-        
-        // Update brightness direction
-        if (direction) {
-            if (newBrightness + BRIGHTNESS_STEP >= MAX_BRIGHTNESS) {
-                newBrightness = MAX_BRIGHTNESS;
-                direction = 0;
-            } else {
-                newBrightness += BRIGHTNESS_STEP;
-            }
-        } else {
-            if (newBrightness - BRIGHTNESS_STEP <= MIN_BRIGHTNESS) {
-                newBrightness = MIN_BRIGHTNESS;
-                direction = 1;
-            } else {
-                newBrightness -= BRIGHTNESS_STEP;
-            }
-        }
-        
-        // Apply brightness change
-        if (newBrightness != currentBrightness) {
-            currentBrightness = newBrightness;
-            lightService->setBrightness(currentBrightness);
-        }
+    uint16_t steps = consumeSteps(dt, speed);
+    phase = (phase + steps) % BREATH_STEPS;
+    
+    // Interpolate between two table entries with the time left over, so the
+    // 16-bit brightness changes a little every frame instead of in steps
+    int32_t from = breathTable[phase] * 257;
+    int32_t to = breathTable[(phase + 1) % BREATH_STEPS] * 257;
+    int32_t brightness = from + (to - from) * (int32_t)stepAccumulator / (int32_t)speed;
+    if (effectActive) {
+        // Breathing depth follows the loudness of the clip
+        brightness = brightness * (effectIntensity(now) + 1) >> 8;
     }
+    lightService->setBrightness16((uint16_t)brightness);
 }
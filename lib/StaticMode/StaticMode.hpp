@@ -5,17 +5,21 @@
 
 class StaticMode : public AbstractMode {
     private:
-        uint8_t currentBrightness = MIN_BRIGHTNESS;
-        uint8_t newBrightness = MIN_BRIGHTNESS;
-        uint8_t direction = 1; // 1 = increasing, 0 = decreasing
-        unsigned long lastUpdate = 0;
+        // Steps from MIN_BRIGHTNESS to MAX_BRIGHTNESS, one breath is twice that
+        static const uint16_t RAMP_STEPS = (MAX_BRIGHTNESS - MIN_BRIGHTNESS + BRIGHTNESS_STEP - 1) / BRIGHTNESS_STEP;
+        static const uint16_t BREATH_STEPS = RAMP_STEPS * 2;
+        
+        uint8_t breathTable[BREATH_STEPS]; // Brightness per phase, built once
+        uint16_t phase = 0;                // Index into breathTable
         unsigned long speed = BREATH_SPEED_NORMAL;
         
+        void buildBreathTable();
+        
     public:
         StaticMode(LightService* lightService, SpeakerService* speakerService);
         
         void donationTriggered() override;
-        void loop() override;
+        void renderFrame(unsigned long now, unsigned long dt) override;
         void setup() override;
 };
 
@@ -2,12 +2,28 @@
 #include "Config.h"
 #include <Arduino.h>
 
+static const char waveModeDescription[] PROGMEM = "Wave effect moving through LED strip";
+static const char waveModeAuthor[] PROGMEM = "Friedjof";
+static const char waveModeVersion[] PROGMEM = "v1.0.0";
+static const ModeInfo waveModeInfo = {"Wave Motion", waveModeDescription, waveModeAuthor, waveModeVersion};
+
 WaveMode::WaveMode(LightService* lightService, SpeakerService* speakerService) 
-    : AbstractMode(lightService, speakerService,
-                  "Wave Motion",
-                  "Wave effect moving through LED strip",
-                  "Friedjof",
-                  "v1.0.0") {
+    : AbstractMode(lightService, speakerService, waveModeInfo) {
+    buildGradient();
+}
+
+void WaveMode::buildGradient() {
+    baseColor = CRGB::White;
+    baseColor.fadeToBlackBy(200); // Very dim base lighting
+    
+    // Create gradient within wave
+    for (uint8_t i = 0; i < WAVE_WIDTH; i++) {
+        uint8_t brightness = 255 - (i * 60); // Less aggressive fade
+        waveGradient[i] = CRGB::White;
+        waveGradient[i].fadeToBlackBy(255 - brightness);
+    }
+    
+    effectColor = CRGB::White; // Full brightness during donation
 }
 
 void WaveMode::setup() {
@@ -21,7 +37,6 @@ void WaveMode::setup() {
     
     wavePosition = 0;
     currentSpeed = normalSpeed;
-    lastUpdate = millis();
     
     // Initial wave setup
     updateWave();
@@ -36,54 +51,45 @@ void WaveMode::donationTriggered() {
     // Speed up wave movement
     currentSpeed = fastSpeed;
     
-    // Play sound
-    speakerService->playDonationSound();
+    // Play sound, the effect lasts as long as the clip
+    startDonationSound();
 }
 
-void WaveMode::loop() {
-    unsigned long currentTime = millis();
-    
+void WaveMode::renderFrame(unsigned long now, unsigned long dt) {
     // Check if donation effect should end
-    if (effectActive && currentTime - effectStartTime >= effectDuration) {
+    if (donationEffectDone(now)) {
         endDonationEffect();
         currentSpeed = normalSpeed; // Reset to normal speed
         Serial.println("[INFO] WaveMode donation effect ended - mode will deactivate");
     }
+
+    // Effect brightness follows the loudness of the clip
+    if (effectActive) {
+        lightService->setBrightness(effectIntensity(now));
+    }
     
     // Wave movement timing
-    if (currentTime - lastUpdate >= currentSpeed) {
-        lastUpdate = currentTime;
-        
-        // Move wave position
-        wavePosition++;
-        if (wavePosition >= NUM_LEDS) {
-            wavePosition = 0;
-        }
-        
-        updateWave();
+    uint16_t steps = consumeSteps(dt, currentSpeed);
+    if (steps == 0) {
+        return;
     }
+    
+    // Move wave position
+    wavePosition = (wavePosition + steps) % NUM_LEDS;
+    
+    updateWave();
 }
 
 void WaveMode::updateWave() {
     // First set all LEDs to dim white for base lighting
-    for (int i = 0; i < NUM_LEDS; i++) {
-        CRGB dimWhite = CRGB::White;
-        dimWhite.fadeToBlackBy(200); // Very dim base lighting
-        lightService->setLedColor(i, dimWhite);
-    }
+    lightService->setColor(baseColor);
     
     // Set wave LEDs to bright white
-    for (int i = 0; i < waveWidth; i++) {
-        int ledIndex = (wavePosition + i) % NUM_LEDS;
-        
-        // Create gradient within wave
-        uint8_t brightness = 255 - (i * 60); // Less aggressive fade
-        if (effectActive) {
-            brightness = 255; // Full brightness during donation
+    uint16_t ledIndex = wavePosition;
+    for (uint8_t i = 0; i < WAVE_WIDTH; i++) {
+        lightService->setLedColor(ledIndex, effectActive ? effectColor : waveGradient[i]);
+        if (++ledIndex >= NUM_LEDS) {
+            ledIndex = 0;
         }
-        
-        CRGB color = CRGB::White;
-        color.fadeToBlackBy(255 - brightness);
-        lightService->setLedColor(ledIndex, color);
     }
 }
@@ -5,9 +5,11 @@
 
 class WaveMode : public AbstractMode {
     private:
-        uint8_t wavePosition = 0;
-        uint8_t waveWidth = 2; // Width of the wave
-        unsigned long lastUpdate = 0;
+        uint16_t wavePosition = 0;
+        static const uint8_t WAVE_WIDTH = 2; // Width of the wave
+        CRGB baseColor;                      // Dim white base lighting
+        CRGB waveGradient[WAVE_WIDTH];       // Wave colors, brightest first
+        CRGB effectColor;                    // Wave color during donation
         unsigned long normalSpeed = 200; // Normal wave speed
         unsigned long fastSpeed = 50;    // Fast wave speed during donation
         unsigned long currentSpeed = 200;
@@ -16,10 +18,11 @@ class WaveMode : public AbstractMode {
         WaveMode(LightService* lightService, SpeakerService* speakerService);
         
         void donationTriggered() override;
-        void loop() override;
+        void renderFrame(unsigned long now, unsigned long dt) override;
         void setup() override;
         
     private:
+        void buildGradient();
         void updateWave();
 };
 
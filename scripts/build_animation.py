@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""
+Assembler for AnimationMode programs (see lib/AnimationMode/README.md)
+Turns a text program into the binary stored as /anim.bin on the box
+
+Usage:
+  python3 build_animation.py rainbow.anim rainbow.bin
+  python3 build_animation.py rainbow.anim --hex        # Print the program as hex
+  mosquitto_pub -h <broker> -t "donation-box/<client>/cmd/animation" -f rainbow.bin
+
+Program text, one instruction per line, "#" starts a comment:
+  effect 2500              # Donation effect length in ms
+  bright 200
+  fill 255 0 80
+  loop:                    # Label, target of jump/repeat
+  fade 2000 0 80 255
+  jump loop
+  donation:                # The donation track starts here (optional)
+  fill 255 255 255
+  ...
+"""
+
+import struct
+import sys
+
+MAGIC = 0x4E41  # "AN"
+VERSION = 1
+NO_TRACK = 0xFFFF
+MAX_SIZE = 512  # ANIMATION_MAX_SIZE in Config.h
+
+# Opcode and operand formats (struct codes), must match AnimationOp
+OPS = {
+    "end":    (0x00, ""),
+    "select": (0x01, "HH"),
+    "face":   (0x02, "B"),
+    "fill":   (0x03, "BBB"),
+    "fade":   (0x04, "HBBB"),
+    "wait":   (0x05, "H"),
+    "bright": (0x06, "B"),
+    "jump":   (0x07, "@"),
+    "repeat": (0x08, "B@"),
+}
+
+
+def parse_value(text, code, labels, resolve):
+    if code == "@":
+        if not resolve:
+            return 0
+        if text not in labels:
+            raise ValueError(f"Unknown label '{text}'")
+        return labels[text]
+    value = int(text, 0)
+    limit = 0xFF if code == "B" else 0xFFFF
+    if not 0 <= value <= limit:
+        raise ValueError(f"Value {value} out of range")
+    return value
+
+
+def assemble(source):
+    """Assemble program text into the binary program (bytes)"""
+    lines = []
+    for number, line in enumerate(source.splitlines(), 1):
+        line = line.split("#", 1)[0].strip()
+        if line:
+            lines.append((number, line))
+
+    effect_ms = 3000
+    labels = {}
+    code = b""
+    # First pass collects the labels, the second one fills in their offsets
+    for resolve in (False, True):
+        code = b""
+        for number, line in lines:
+            try:
+                if line.endswith(":"):
+                    labels[line[:-1]] = len(code)
+                    continue
+                name, *args = line.split()
+                if name == "effect":
+                    effect_ms = parse_value(args[0], "H", labels, resolve)
+                    continue
+                if name not in OPS:
+                    raise ValueError(f"Unknown instruction '{name}'")
+                opcode, operands = OPS[name]
+                if len(args) != len(operands):
+                    raise ValueError(f"'{name}' takes {len(operands)} operands")
+                values = [parse_value(arg, kind, labels, resolve) for arg, kind in zip(args, operands)]
+                code += bytes([opcode]) + struct.pack("<" + operands.replace("@", "H"), *values)
+            except (ValueError, IndexError) as error:
+                raise ValueError(f"Line {number}: {error}") from None
+
+    donation = labels.get("donation", NO_TRACK)
+    program = struct.pack("<HBBHHH", MAGIC, VERSION, 0, donation, effect_ms, len(code)) + code
+    if len(program) > MAX_SIZE:
+        raise ValueError(f"Program has {len(program)} bytes, the box takes at most {MAX_SIZE}")
+    return program
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+    try:
+        with open(sys.argv[1]) as source:
+            program = assemble(source.read())
+    except (OSError, ValueError) as error:
+        print(f"Cannot assemble {sys.argv[1]}: {error}", file=sys.stderr)
+        return 1
+
+    if sys.argv[2] == "--hex":
+        print(program.hex())
+    else:
+        with open(sys.argv[2], "wb") as target:
+            target.write(program)
+        print(f"{len(program)} bytes written to {sys.argv[2]}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Decoder for the binary status/heartbeat records (MQTT_BINARY_TELEMETRY)
+Returns the same fields as the JSON payloads, JSON input is passed through
+
+Usage:
+  mosquitto_sub -h <broker> -t "donation-box/+/heartbeat" -F %x | python3 decode_telemetry.py
+  python3 decode_telemetry.py 0102032c010000...   # One hex encoded record
+
+As a library (e.g. in a Home Assistant bridge):
+  from decode_telemetry import decode
+  fields = decode(message.payload)
+"""
+
+import json
+import struct
+import sys
+
+TELEMETRY_VERSION = 1
+RECORD_TYPES = {1: "status", 2: "heartbeat"}
+
+WIFI_CONNECTED = 0x01
+MQTT_CONNECTED = 0x02
+IO_STACK = 0x04
+WIFI_FAST = 0x08
+
+# Version, type, flags, uptime, free heap, min free heap, largest block,
+# fragmentation, loop stack free, I/O stack free
+HEADER = struct.Struct("<BBBIIIIBHH")
+
+
+def decode(payload):
+    """Decode one record (bytes) into a dict with the JSON field names"""
+    if payload[:1] == b"{":
+        return json.loads(payload)
+    if len(payload) < HEADER.size:
+        raise ValueError(f"Record too short: {len(payload)} bytes")
+
+    (version, record_type, flags, uptime, free_heap, min_free_heap,
+     largest_block, fragmentation, loop_stack, io_stack) = HEADER.unpack_from(payload)
+    if version != TELEMETRY_VERSION:
+        raise ValueError(f"Unsupported telemetry version {version}")
+    if record_type not in RECORD_TYPES:
+        raise ValueError(f"Unknown record type {record_type}")
+
+    fields = {
+        "event": RECORD_TYPES[record_type],
+        "uptime": uptime,
+        "free_heap": free_heap,
+        "min_free_heap": min_free_heap,
+        "largest_block": largest_block,
+        "heap_fragmentation": fragmentation,
+        "loop_stack_free": loop_stack,
+    }
+    if flags & IO_STACK:
+        fields["io_stack_free"] = io_stack
+
+    if RECORD_TYPES[record_type] == "status":
+        fields["wifi_connected"] = bool(flags & WIFI_CONNECTED)
+        fields["mqtt_connected"] = bool(flags & MQTT_CONNECTED)
+        offset = HEADER.size
+        if len(payload) <= offset or len(payload) < offset + 1 + payload[offset]:
+            raise ValueError("Status text truncated")
+        length = payload[offset]
+        fields["status"] = payload[offset + 1:offset + 1 + length].decode("utf-8", "replace")
+        # Connect time follows the text, records of older firmware end here
+        offset += 1 + length
+        if len(payload) >= offset + 2:
+            fields["wifi_connect_ms"] = struct.unpack_from("<H", payload, offset)[0]
+            fields["wifi_fast"] = bool(flags & WIFI_FAST)
+    return fields
+
+
+def main():
+    lines = sys.argv[1:] or sys.stdin
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            print(json.dumps(decode(bytes.fromhex(line))))
+        except ValueError as error:
+            print(f"Cannot decode record: {error}", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""
+Measures the MP3 files on the DFPlayer SD card and prints include/SoundTable.h
+Clip length plus a loudness envelope per file, so donation effects follow
+the sound (see include/SoundTable.h.example). Needs ffmpeg on the PATH.
+
+Usage:
+  python3 measure_sounds.py /path/to/sdcard > include/SoundTable.h
+  python3 measure_sounds.py /path/to/sdcard --points 8
+"""
+
+import argparse
+import array
+import math
+import os
+import re
+import subprocess
+import sys
+
+SAMPLE_RATE = 8000
+MIN_LEVEL = 64     # Quietest envelope level, keeps the LEDs from going dark
+SILENCE = 0.02     # Trailing samples below this share of the peak are not counted
+
+
+def decode(path):
+    """Decode a file to mono 16 bit samples at SAMPLE_RATE"""
+    result = subprocess.run(
+        ["ffmpeg", "-v", "error", "-i", path, "-f", "s16le", "-ac", "1", "-ar", str(SAMPLE_RATE), "-"],
+        check=True, stdout=subprocess.PIPE)
+    samples = array.array("h")
+    samples.frombytes(result.stdout[:len(result.stdout) // 2 * 2])
+    return samples
+
+
+def measure(samples, points):
+    """Audible length in ms and the loudness envelope (MIN_LEVEL..255)"""
+    peak = max((abs(s) for s in samples), default=0)
+    if peak == 0:
+        return 0, [MIN_LEVEL] * points
+
+    # Trailing silence does not count, the DFPlayer still reports it as playing
+    end = len(samples)
+    while end > 0 and abs(samples[end - 1]) < peak * SILENCE:
+        end -= 1
+
+    rms = []
+    for i in range(points):
+        window = samples[end * i // points:max(end * (i + 1) // points, end * i // points + 1)]
+        rms.append(math.sqrt(sum(s * s for s in window) / len(window)))
+    loudest = max(rms) or 1
+    levels = [round(MIN_LEVEL + (255 - MIN_LEVEL) * value / loudest) for value in rms]
+    return end * 1000 // SAMPLE_RATE, levels
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("card", help="SD card root (001.mp3, 002.mp3, ...)")
+    parser.add_argument("--points", type=int, default=8, help="SOUND_ENVELOPE_POINTS in Config.h")
+    args = parser.parse_args()
+
+    # The DFPlayer numbers files by their leading digits
+    files = {}
+    for name in os.listdir(args.card):
+        match = re.match(r"(\d{3,4}).*\.(mp3|wav)$", name, re.IGNORECASE)
+        if match:
+            files[int(match.group(1))] = os.path.join(args.card, name)
+    if not files:
+        print(f"No numbered MP3 files in {args.card}", file=sys.stderr)
+        return 1
+
+    entries = []
+    for track in range(1, max(files) + 1):
+        if track not in files:
+            # Duration 0: the effect falls back to the playback-finished message
+            entries.append((f"{track:03d} (missing)", 0, [MIN_LEVEL] * args.points))
+            continue
+        try:
+            duration, levels = measure(decode(files[track]), args.points)
+        except (OSError, subprocess.CalledProcessError) as error:
+            print(f"Cannot decode {files[track]}: {error}", file=sys.stderr)
+            return 1
+        entries.append((os.path.basename(files[track]), duration, levels))
+
+    print("// Generated by scripts/measure_sounds.py, see SoundTable.h.example")
+    print("#ifndef SOUND_TABLE_H")
+    print("#define SOUND_TABLE_H")
+    print()
+    print("#define SOUND_TABLE \\")
+    for i, (name, duration, levels) in enumerate(entries):
+        last = i == len(entries) - 1
+        values = ", ".join(f"{level:3d}" for level in levels)
+        line = f"    {{ {duration:5d}, {{{values}}} }}{' ' if last else ','} /* {name} */"
+        print(line if last else line + " \\")
+    print()
+    print("#endif // SOUND_TABLE_H")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
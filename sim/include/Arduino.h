@@ -0,0 +1,112 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// Minimal Arduino API for the native (host) build, only what the portable
+// services and modes use. Time is simulated and advanced by the runner.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define IRAM_ATTR
+#define PROGMEM
+#define F(string_literal) (string_literal)
+#define memcpy_P memcpy
+
+// Flash strings are plain strings on the host
+class __FlashStringHelper;
+#define FPSTR(pstr_pointer) (reinterpret_cast<const __FlashStringHelper*>(pstr_pointer))
+
+// ============================================================================
+//                              SIMULATED TIME
+// ============================================================================
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Simulation control (native build only)
+void simAdvanceMicros(unsigned long us);
+inline void simAdvanceMillis(unsigned long ms) { simAdvanceMicros(ms * 1000UL); }
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// ============================================================================
+//                                  MATH
+// ============================================================================
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+template <typename T, typename U>
+inline typename std::common_type<T, U>::type min(T a, U b) { return a < b ? a : b; }
+template <typename T, typename U>
+inline typename std::common_type<T, U>::type max(T a, U b) { return a > b ? a : b; }
+
+// ============================================================================
+//                                 STRING
+// ============================================================================
+class String {
+    private:
+        std::string value;
+
+    public:
+        String() {}
+        String(const char* text) : value(text ? text : "") {}
+        String(const std::string& text) : value(text) {}
+        String(char c) : value(1, c) {}
+        String(int number) : value(std::to_string(number)) {}
+        String(unsigned int number) : value(std::to_string(number)) {}
+        String(long number) : value(std::to_string(number)) {}
+        String(unsigned long number) : value(std::to_string(number)) {}
+
+        const char* c_str() const { return value.c_str(); }
+        unsigned int length() const { return value.length(); }
+        long toInt() const { return atol(value.c_str()); }
+
+        String& operator+=(const String& other) { value += other.value; return *this; }
+        friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+        bool operator==(const String& other) const { return value == other.value; }
+        bool operator!=(const String& other) const { return value != other.value; }
+};
+
+// ============================================================================
+//                                 SERIAL
+// ============================================================================
+// Writes to stdout when enabled, the runner mutes it for fast runs
+class SimSerial {
+    public:
+        bool enabled = false;
+
+        void begin(unsigned long baud) { (void)baud; }
+
+        void print(const char* text);
+        void print(const String& text) { print(text.c_str()); }
+        void print(const __FlashStringHelper* text) { print(reinterpret_cast<const char*>(text)); }
+        void print(char c);
+        void print(long number);
+        void print(unsigned long number);
+        void print(int number) { print((long)number); }
+        void print(unsigned int number) { print((unsigned long)number); }
+        void print(double number);
+
+        template <typename T>
+        void println(const T& value) { print(value); print('\n'); }
+        void println() { print('\n'); }
+};
+
+extern SimSerial Serial;
+
+#endif // SIM_ARDUINO_H
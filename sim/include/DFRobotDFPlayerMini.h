@@ -0,0 +1,27 @@
+#ifndef SIM_DFROBOT_DFPLAYER_MINI_H
+#define SIM_DFROBOT_DFPLAYER_MINI_H
+
+// Message constants of DFRobotDFPlayerMini for the native (host) build
+
+#define TimeOut 0
+#define WrongStack 1
+#define DFPlayerCardInserted 2
+#define DFPlayerCardRemoved 3
+#define DFPlayerCardOnline 4
+#define DFPlayerPlayFinished 5
+#define DFPlayerError 6
+#define DFPlayerUSBInserted 7
+#define DFPlayerUSBRemoved 8
+#define DFPlayerUSBOnline 9
+#define DFPlayerCardUSBOnline 10
+#define DFPlayerFeedBack 11
+
+#define Busy 1
+#define Sleeping 2
+#define SerialWrongStack 3
+#define CheckSumNotMatch 4
+#define FileIndexOut 5
+#define FileMismatch 6
+#define Advertise 7
+
+#endif // SIM_DFROBOT_DFPLAYER_MINI_H
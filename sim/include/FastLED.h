@@ -0,0 +1,44 @@
+#ifndef SIM_FASTLED_H
+#define SIM_FASTLED_H
+
+// CRGB subset of FastLED for the native (host) build
+
+#include <Arduino.h>
+
+struct CRGB {
+    union {
+        struct {
+            uint8_t r;
+            uint8_t g;
+            uint8_t b;
+        };
+        uint8_t raw[3];
+    };
+
+    enum HTMLColorCode {
+        Black = 0x000000,
+        White = 0xFFFFFF,
+        Red   = 0xFF0000,
+        Green = 0x008000,
+        Blue  = 0x0000FF
+    };
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+    CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+    CRGB(HTMLColorCode colorcode) : CRGB((uint32_t)colorcode) {}
+
+    // Same rounding as FastLED's scale8 (FASTLED_SCALE8_FIXED)
+    CRGB& nscale8(uint8_t scale) {
+        for (uint8_t i = 0; i < 3; i++) {
+            raw[i] = ((uint16_t)raw[i] * (1 + scale)) >> 8;
+        }
+        return *this;
+    }
+    CRGB& fadeToBlackBy(uint8_t fadeFactor) { return nscale8(255 - fadeFactor); }
+
+    bool operator==(const CRGB& other) const { return r == other.r && g == other.g && b == other.b; }
+    bool operator!=(const CRGB& other) const { return !(*this == other); }
+};
+
+#endif // SIM_FASTLED_H
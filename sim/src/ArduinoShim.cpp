@@ -0,0 +1,74 @@
+#include <Arduino.h>
+#include <stdio.h>
+
+SimSerial Serial;
+
+static unsigned long long simMicros = 0;
+static unsigned long randomState = 1;
+
+unsigned long millis() {
+    return (unsigned long)(simMicros / 1000ULL);
+}
+
+unsigned long micros() {
+    return (unsigned long)simMicros;
+}
+
+void simAdvanceMicros(unsigned long us) {
+    simMicros += us;
+}
+
+void delay(unsigned long ms) {
+    simAdvanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+    simAdvanceMicros(us);
+}
+
+// Deterministic generator, the same seed replays the same run
+long random(long max) {
+    if (max <= 0) {
+        return 0;
+    }
+    randomState = randomState * 1103515245UL + 12345UL;
+    return (long)((randomState >> 16) % (unsigned long)max);
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    randomState = seed;
+}
+
+void SimSerial::print(const char* text) {
+    if (enabled) {
+        fputs(text, stdout);
+    }
+}
+
+void SimSerial::print(char c) {
+    if (enabled) {
+        fputc(c, stdout);
+    }
+}
+
+void SimSerial::print(long number) {
+    if (enabled) {
+        printf("%ld", number);
+    }
+}
+
+void SimSerial::print(unsigned long number) {
+    if (enabled) {
+        printf("%lu", number);
+    }
+}
+
+void SimSerial::print(double number) {
+    if (enabled) {
+        printf("%.2f", number);
+    }
+}
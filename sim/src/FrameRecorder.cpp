@@ -0,0 +1,25 @@
+#include "FrameRecorder.hpp"
+
+void FrameRecorder::begin(CRGB* leds, uint16_t count) {
+    this->leds = leds;
+    this->count = count;
+}
+
+void FrameRecorder::show() {
+    frames++;
+    
+    checksum = (checksum ^ brightness) * 16777619UL;
+    for (uint16_t i = 0; i < count; i++) {
+        for (uint8_t c = 0; c < 3; c++) {
+            checksum = (checksum ^ leds[i].raw[c]) * 16777619UL;
+        }
+    }
+    
+    if (output) {
+        fprintf(output, "%lu,%u", millis(), brightness);
+        for (uint16_t i = 0; i < count; i++) {
+            fprintf(output, ",%02X%02X%02X", leds[i].r, leds[i].g, leds[i].b);
+        }
+        fputc('\n', output);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef FRAME_RECORDER_HPP
+#define FRAME_RECORDER_HPP
+
+#include <stdio.h>
+#include "LedDriver.hpp"
+
+// Fake LedDriver: counts shown frames and optionally writes them as CSV
+class FrameRecorder : public LedDriver {
+    private:
+        CRGB* leds = nullptr;
+        uint16_t count = 0;
+        uint8_t brightness = 255;
+        FILE* output = nullptr;
+        unsigned long frames = 0;
+        uint32_t checksum = 2166136261UL; // FNV-1a over all shown frames
+
+    public:
+        // One line per frame: millis,brightness,RRGGBB,... (nullptr = count only)
+        void recordTo(FILE* file) { output = file; }
+
+        void begin(CRGB* leds, uint16_t count) override;
+        void setBrightness(uint8_t brightness) override { this->brightness = brightness; }
+        void show() override;
+
+        unsigned long getFrames() const { return frames; }
+        uint32_t getChecksum() const { return checksum; }
+};
+
+#endif // FRAME_RECORDER_HPP
@@ -0,0 +1,41 @@
+#include "RecordingAudioPlayer.hpp"
+#include "DFRobotDFPlayerMini.h"
+
+bool RecordingAudioPlayer::available() {
+    if (cardOnlinePending) {
+        return true;
+    }
+    // Latched here like in DFRobotDFPlayerMini, read() may be called before readType()
+    if (playingTrack != 0 && millis() >= finishAt) {
+        finishedTrack = playingTrack;
+        playingTrack = 0;
+        finishPending = true;
+    }
+    return finishPending;
+}
+
+uint8_t RecordingAudioPlayer::readType() {
+    if (cardOnlinePending) {
+        cardOnlinePending = false;
+        return DFPlayerCardOnline;
+    }
+    finishPending = false;
+    return DFPlayerPlayFinished;
+}
+
+void RecordingAudioPlayer::play(int track) {
+    record(PLAY, track);
+    // A new track cuts the running one off without a finished message
+    playingTrack = track;
+    finishAt = millis() + clipLength(track);
+}
+
+size_t RecordingAudioPlayer::count(CommandType type) const {
+    size_t total = 0;
+    for (const Command& command : commands) {
+        if (command.type == type) {
+            total++;
+        }
+    }
+    return total;
+}
@@ -0,0 +1,62 @@
+#ifndef RECORDING_AUDIO_PLAYER_HPP
+#define RECORDING_AUDIO_PLAYER_HPP
+
+#include <vector>
+#include "AudioPlayer.hpp"
+
+// Fake AudioPlayer: accepts every command and records it with its time
+class RecordingAudioPlayer : public AudioPlayer {
+    public:
+        enum CommandType : uint8_t {
+            PLAY,
+            VOLUME,
+            PAUSE,
+            START,
+            STOP,
+            NEXT,
+            PREVIOUS,
+            RESET
+        };
+
+        struct Command {
+            unsigned long timeMs;
+            CommandType type;
+            int argument;
+        };
+
+    private:
+        std::vector<Command> commands;
+        bool cardOnlinePending = false;
+        int playingTrack = 0;   // 0 = silent
+        int finishedTrack = 0;  // Value of the last playback-finished message
+        bool finishPending = false;
+        unsigned long finishAt = 0;
+
+        void record(CommandType type, int argument = 0) { commands.push_back({millis(), type, argument}); }
+
+    public:
+        bool begin() override { cardOnlinePending = true; return true; }
+        void setTimeOut(unsigned long timeoutMs) override { (void)timeoutMs; }
+
+        // Reports "card online" once after begin() and "finished" at the end
+        // of every clip (track n lasts clipLength(n)), no ACK timeouts
+        bool available() override;
+        uint8_t readType() override;
+        int read() override { return finishedTrack; }
+
+        static unsigned long clipLength(int track) { return 1500 + 100 * track; }
+
+        void play(int track) override;
+        void volume(uint8_t volume) override { record(VOLUME, volume); }
+        void pause() override { record(PAUSE); }
+        void start() override { record(START); }
+        void stop() override { record(STOP); }
+        void next() override { record(NEXT); }
+        void previous() override { record(PREVIOUS); }
+        void reset() override { record(RESET); }
+
+        const std::vector<Command>& getCommands() const { return commands; }
+        size_t count(CommandType type) const;
+};
+
+#endif // RECORDING_AUDIO_PLAYER_HPP
@@ -0,0 +1,38 @@
+#include "ScriptedSensorInput.hpp"
+#include <algorithm>
+
+void ScriptedSensorInput::addCoin(unsigned long startMs, unsigned long durationMs) {
+    script.push_back({startMs, LOW});
+    script.push_back({startMs + durationMs, HIGH});
+    std::stable_sort(script.begin(), script.end(),
+                     [](const Change& a, const Change& b) { return a.timeMs < b.timeMs; });
+}
+
+void ScriptedSensorInput::addBouncyCoin(unsigned long startMs, unsigned long durationMs, uint8_t bounces) {
+    // A few 1 ms glitches before the level settles
+    for (uint8_t i = 0; i < bounces; i++) {
+        script.push_back({startMs + i * 2, LOW});
+        script.push_back({startMs + i * 2 + 1, HIGH});
+    }
+    addCoin(startMs + bounces * 2, durationMs);
+}
+
+uint8_t ScriptedSensorInput::read() {
+    unsigned long now = millis();
+    while (position < script.size() && script[position].timeMs <= now) {
+        level = script[position].level;
+        position++;
+    }
+    return level;
+}
+
+size_t ScriptedSensorInput::getCoinCount() const {
+    size_t coins = 0;
+    for (size_t i = 1; i < script.size(); i++) {
+        if (script[i].level == HIGH && script[i - 1].level == LOW &&
+            script[i].timeMs - script[i - 1].timeMs > 1) {
+            coins++;
+        }
+    }
+    return coins;
+}
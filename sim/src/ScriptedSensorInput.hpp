@@ -0,0 +1,33 @@
+#ifndef SCRIPTED_SENSOR_INPUT_HPP
+#define SCRIPTED_SENSOR_INPUT_HPP
+
+#include <vector>
+#include "SensorInput.hpp"
+
+// Fake SensorInput: replays level changes at given simulated times
+class ScriptedSensorInput : public SensorInput {
+    private:
+        struct Change {
+            unsigned long timeMs;
+            uint8_t level;
+        };
+
+        std::vector<Change> script; // Sorted by time
+        size_t position = 0;
+        uint8_t level = HIGH;
+
+    public:
+        // Sensor goes LOW (coin in front of the TCRT5000) for durationMs
+        void addCoin(unsigned long startMs, unsigned long durationMs);
+        // Same coin with a few 1 ms contact bounces in front
+        void addBouncyCoin(unsigned long startMs, unsigned long durationMs, uint8_t bounces);
+
+        void begin() override { position = 0; level = HIGH; }
+        uint8_t read() override;
+        // Polling only, loop() samples the script
+        bool attachChangeHandler(LevelHandler handler) override { (void)handler; return false; }
+
+        size_t getCoinCount() const;
+};
+
+#endif // SCRIPTED_SENSOR_INPUT_HPP
@@ -0,0 +1,79 @@
+#include "TimingChecks.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+// Every C++ allocation of the simulator goes through here
+static unsigned long heapAllocations = 0;
+
+void* operator new(size_t size) {
+    heapAllocations++;
+    void* memory = malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void TimingChecks::beginPass() {
+    framesBefore = frameRecorder.getFrames();
+    allocationsBefore = heapAllocations;
+}
+
+void TimingChecks::endPass() {
+    passes++;
+    allocations += heapAllocations - allocationsBefore;
+
+    unsigned long shows = frameRecorder.getFrames() - framesBefore;
+    if (shows > 1) {
+        extraShows++;
+    }
+
+    if (edgePending && shows > 0) {
+        unsigned long latency = millis() - edgeTime;
+        edgeLatency = max(edgeLatency, latency);
+        if (latency > maxEdgeLatencyMs) {
+            lateEdges++;
+        }
+        edgePending = false;
+    }
+}
+
+void TimingChecks::onDonation(uint8_t modeIndex, unsigned long timestampMs) {
+    // A burst is timed from its first coin, the others join its effect
+    if (!edgePending && modes[modeIndex]->getDonationAmount() == 1) {
+        edgePending = true;
+        edgeTime = timestampMs;
+    }
+}
+
+bool TimingChecks::report() const {
+    bool passed = extraShows == 0 && lateEdges == 0 && allocations == 0;
+    printf("Check show per pass: %s (%lu of %lu passes showed twice)\n", extraShows ? "FAIL" : "ok",
+           extraShows, passes);
+    printf("Check edge->frame:   %s (worst %lu ms, limit %lu ms, %lu late)\n", lateEdges ? "FAIL" : "ok",
+           edgeLatency, maxEdgeLatencyMs, lateEdges);
+    printf("Check heap:          %s (%lu allocations in the loop)\n", allocations ? "FAIL" : "ok", allocations);
+    printf("Checks:              %s\n", passed ? "passed" : "FAILED");
+    return passed;
+}
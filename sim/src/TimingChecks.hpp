@@ -0,0 +1,53 @@
+#ifndef TIMING_CHECKS_HPP
+#define TIMING_CHECKS_HPP
+
+#include "AbstractMode.hpp"
+#include "ControllerObserver.hpp"
+#include "FrameRecorder.hpp"
+
+// Timing guarantees of the render side, checked on every simulated loop pass
+// (--check): at most one show() per pass, a coin that starts an effect
+// reaches the strip within maxEdgeLatencyMs, and no heap allocation once the
+// loop runs. Coins that join a running effect are not timed, they may not
+// change the frame at all.
+class TimingChecks : public ControllerObserver {
+    private:
+        const FrameRecorder& frameRecorder;
+        AbstractMode* const* modes;    // The Controller's, to tell a new effect from a joined one
+        unsigned long maxEdgeLatencyMs;
+
+        // Current pass
+        unsigned long framesBefore = 0;
+        unsigned long allocationsBefore = 0;
+
+        bool edgePending = false;      // Coin counted, no frame shown since
+        unsigned long edgeTime = 0;
+
+        unsigned long passes = 0;
+        unsigned long extraShows = 0;  // Passes with more than one show()
+        unsigned long lateEdges = 0;
+        unsigned long edgeLatency = 0; // Worst coin to shown frame
+        unsigned long allocations = 0; // Heap allocations inside passes
+
+    public:
+        TimingChecks(const FrameRecorder& frameRecorder, AbstractMode* const* modes, unsigned long maxEdgeLatencyMs)
+            : frameRecorder(frameRecorder), modes(modes), maxEdgeLatencyMs(maxEdgeLatencyMs) {}
+
+        // Around the render side of one loop pass (sensor, Controller, frame commit)
+        void beginPass();
+        void endPass();
+
+        void onDonation(uint8_t modeIndex, unsigned long timestampMs) override;
+
+        // Prints the results, false if a guarantee was broken
+        bool report() const;
+
+        // Results so far, for the unit tests in test/test_native
+        unsigned long getPasses() const { return passes; }
+        unsigned long getExtraShows() const { return extraShows; }
+        unsigned long getLateEdges() const { return lateEdges; }
+        unsigned long getEdgeLatency() const { return edgeLatency; }
+        unsigned long getAllocations() const { return allocations; }
+};
+
+#endif // TIMING_CHECKS_HPP
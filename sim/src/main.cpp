@@ -0,0 +1,208 @@
+// Native simulator: runs the Controller and all seven modes on the host
+// against fake hardware, as fast as the PC allows.
+//
+//   .pio/build/native/program [--seconds N] [--coin-every MS] [--burst N] [--seed N]
+//                             [--frames FILE] [--check] [--verbose]
+//
+// --check exits with 1 if a timing guarantee was broken (see TimingChecks.hpp)
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <chrono>
+
+#include "Controller.hpp"
+#include "LightService.hpp"
+#include "SpeakerService.hpp"
+#include "SensorService.hpp"
+#include "DonationStats.hpp"
+
+#include "StaticMode.hpp"
+#include "WaveMode.hpp"
+#include "BlinkMode.hpp"
+#include "HalfMode.hpp"
+#include "CenterMode.hpp"
+#include "ChaseMode.hpp"
+#include "AnimationMode.hpp"
+
+#include "FrameRecorder.hpp"
+#include "ScriptedSensorInput.hpp"
+#include "RecordingAudioPlayer.hpp"
+#include "TimingChecks.hpp"
+
+// pio test -e native builds the fakes without the runner, test/test_native has its own main()
+#ifndef PIO_UNIT_TESTING
+
+// Counts the events the Controller pushes
+class RunStats : public ControllerObserver {
+    public:
+        unsigned long donations = 0;
+        unsigned long modeSwitches = 0;
+
+        void onModeChanged(uint8_t fromIndex, uint8_t toIndex) override { modeSwitches++; }
+        void onDonation(uint8_t modeIndex, unsigned long timestampMs) override { donations++; }
+};
+
+struct Options {
+    unsigned long seconds = 600;     // Simulated run time
+    unsigned long coinEvery = 7000;  // Coin interval in ms (0 = no coins)
+    unsigned long burst = 1;         // Coins dropped together, 250 ms apart
+    unsigned long seed = 1;
+    const char* framesFile = nullptr;
+    bool check = false;
+    bool verbose = false;
+};
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seconds" && hasValue) {
+            options.seconds = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--coin-every" && hasValue) {
+            options.coinEvery = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--burst" && hasValue) {
+            options.burst = max(strtoul(argv[++i], nullptr, 10), 1UL);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--frames" && hasValue) {
+            options.framesFile = argv[++i];
+        } else if (arg == "--check") {
+            options.check = true;
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [--seconds N] [--coin-every MS] [--burst N] [--seed N] [--frames FILE] [--check] [--verbose]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    
+    Serial.enabled = options.verbose;
+    randomSeed(options.seed);
+    
+    // Fake hardware
+    FrameRecorder frameRecorder;
+    ScriptedSensorInput sensorInput;
+    RecordingAudioPlayer audioPlayer;
+    
+    FILE* framesOut = nullptr;
+    if (options.framesFile) {
+        framesOut = fopen(options.framesFile, "w");
+        if (!framesOut) {
+            perror(options.framesFile);
+            return 1;
+        }
+        frameRecorder.recordTo(framesOut);
+    }
+    
+    unsigned long runMs = options.seconds * 1000UL;
+    if (options.coinEvery > 0) {
+        for (unsigned long t = options.coinEvery; t < runMs; t += options.coinEvery) {
+            for (unsigned long coin = 0; coin < options.burst; coin++) {
+                // Every third coin bounces a little
+                unsigned long start = t + coin * 250;
+                if ((t / options.coinEvery + coin) % 3 == 0) {
+                    sensorInput.addBouncyCoin(start, 80, 3);
+                } else {
+                    sensorInput.addCoin(start, 80);
+                }
+            }
+        }
+    }
+    
+    // Same wiring as src/main.cpp
+    LightService lightService(&frameRecorder);
+    SpeakerService speakerService(&audioPlayer);
+    SensorService sensorService(&sensorInput);
+    
+    lightService.setup();
+    sensorService.setup();
+    
+    StaticMode staticMode(&lightService, &speakerService);
+    WaveMode waveMode(&lightService, &speakerService);
+    BlinkMode blinkMode(&lightService, &speakerService);
+    HalfMode halfMode(&lightService, &speakerService);
+    CenterMode centerMode(&lightService, &speakerService);
+    ChaseMode chaseMode(&lightService, &speakerService);
+    AnimationMode animationMode(&lightService, &speakerService); // Built-in program
+    AbstractMode* const modes[] = {&staticMode, &waveMode, &blinkMode, &halfMode, &centerMode, &chaseMode,
+                                   &animationMode};
+    
+    Controller controller(&sensorService, &speakerService, modes);
+    
+    RunStats stats;
+    controller.addObserver(&stats);
+    
+    DonationStats donationStats;
+    donationStats.setup();
+    controller.addObserver(&donationStats);
+    
+    // A coin waits at most one frame interval for its frame, plus the pass that shows it
+    TimingChecks checks(frameRecorder, modes, 1000 / TARGET_FPS + 1);
+    controller.addObserver(&checks);
+    
+    lightService.beginFrame();
+    controller.setup();
+    lightService.commitFrame();
+    
+    speakerService.setup();
+    
+    // Run in 1 ms ticks of simulated time
+    
+    auto wallStart = std::chrono::steady_clock::now();
+    while (millis() < runMs) {
+        simAdvanceMillis(1);
+        
+        // Render side
+        checks.beginPass();
+        lightService.beginFrame();
+        sensorService.loop();
+        controller.loop();
+        lightService.commitFrame();
+        donationStats.loop();
+        checks.endPass();
+        
+        // I/O side
+        speakerService.loop();
+    }
+    auto wallEnd = std::chrono::steady_clock::now();
+    double wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    
+    if (framesOut) {
+        fclose(framesOut);
+    }
+    
+    unsigned long frames = frameRecorder.getFrames();
+    printf("Simulated time:      %lu s\n", options.seconds);
+    printf("Coins scripted:      %zu\n", sensorInput.getCoinCount());
+    printf("Donations detected:  %lu\n", stats.donations);
+    DonationSummary summary;
+    donationStats.snapshot(summary);
+    printf("Donation stats:      %lu total, %u last hour, peak %u/min %u/h\n", (unsigned long)summary.total,
+           summary.lastHour, summary.peakMinute, summary.peakHour);
+    printf("Mode switches:       %lu\n", stats.modeSwitches);
+    printf("Frames shown:        %lu\n", frames);
+    printf("Speaker commands:    %zu (%zu play)\n", audioPlayer.getCommands().size(),
+           audioPlayer.count(RecordingAudioPlayer::PLAY));
+    printf("Sensor edges lost:   %u\n", sensorService.getDroppedEdges());
+    printf("Frame checksum:      %08lx\n", (unsigned long)frameRecorder.getChecksum());
+    printf("Wall time:           %.3f s\n", wallSeconds);
+    if (wallSeconds > 0) {
+        printf("Simulated frames/s:  %.0f\n", frames / wallSeconds);
+        printf("Speed-up:            %.0fx real time\n", options.seconds / wallSeconds);
+    }
+    
+    if (options.check && !checks.report()) {
+        return 1;
+    }
+    return 0;
+}
+
+#endif // PIO_UNIT_TESTING
@@ -6,6 +6,13 @@
 #include "SpeakerService.hpp"
 #include "SensorService.hpp"
 #include "MqttService.hpp"
+#include "Profiler.hpp"
+#include "MemoryMonitor.hpp"
+#include "SerialConsole.hpp"
+#include "SpscQueue.hpp"
+#include "DonationStats.hpp"
+#include "PowerManager.hpp"
+#include "OtaService.hpp"
 
 // Include available modes
 #include "StaticMode.hpp"
@@ -14,43 +21,160 @@
 #include "HalfMode.hpp"
 #include "CenterMode.hpp"
 #include "ChaseMode.hpp"
+#include "AnimationMode.hpp"
 
 #include "Config.h"
 
 // ============================================================================
 //                           SERVICE INSTANCES
 // ============================================================================
-LightService* lightService;
-SpeakerService* speakerService;
-SensorService* sensorService;
-MqttService* mqttService;
+// Everything lives in static storage, so RAM use is known at link time
+LightService lightService;
+SpeakerService speakerService;
+SensorService sensorService(SENSOR_PIN);
+#if ENABLE_MQTT
+char mqttClientId[24]; // MQTT_CLIENT_ID plus a random suffix, filled in setup()
+MqttService mqttService(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER, MQTT_PORT,
+                        mqttClientId, MQTT_USER, MQTT_PASSWORD);
+#endif
+#if ENABLE_SERIAL_CONSOLE
+SerialConsole serialConsole(Serial);
+#endif
+#if ENABLE_DONATION_STATS
+DonationStats donationStats;
+#endif
+#if ENABLE_MQTT && ENABLE_OTA
+OtaService otaService;
+#endif
 
 // ============================================================================
 //                           GLOBAL STATE TRACKING
 // ============================================================================
-// For MQTT integration - track state changes
-String lastModeName = "none";
-unsigned long lastDonationTime = 0;
-bool donationJustDetected = false;
+bool startupAnnounced = false;
+unsigned long firstFrameTime = 0; // millis() since reset when the first frame was shown
+
+#if ENABLE_DONATION_STATS
+uint32_t publishedStatsRevision = 0;
+unsigned long lastStatsPublish = 0;
+
+void printStats(Print& out) {
+  DonationSummary stats;
+  donationStats.snapshot(stats);
+  out.printf("[STATS] Donations:   %lu total, %lu since boot\n",
+             (unsigned long)stats.total, (unsigned long)stats.sinceBoot);
+  out.printf("[STATS] Last hour:   %u\n", stats.lastHour);
+  out.printf("[STATS] Peak:        %u per hour, %u per minute\n", stats.peakHour, stats.peakMinute);
+}
+#endif
+
+#if ENABLE_MQTT
+// Controller events for MQTT, pushed on the render side and drained by serviceIo()
+struct ControllerEvent {
+  bool donation;
+  uint8_t fromIndex; // Mode changes only
+  uint8_t modeIndex;
+};
+
+class MqttEventBridge : public ControllerObserver {
+  public:
+    SpscQueue<ControllerEvent, CONTROLLER_EVENT_QUEUE_SIZE> events;
+    uint16_t reportedDrops = 0;
+
+    void onModeChanged(uint8_t fromIndex, uint8_t toIndex) override {
+      events.push({false, fromIndex, toIndex});
+    }
+    void onDonation(uint8_t modeIndex, unsigned long timestampMs) override {
+      events.push({true, modeIndex, modeIndex});
+    }
+};
+
+MqttEventBridge mqttEvents;
+
+#if ENABLE_MQTT_COMMANDS
+// Remote commands, parsed on the I/O side and applied in loop() next to the Controller
+struct RemoteCommand {
+  MqttCommand command;
+  long value;
+};
+
+SpscQueue<RemoteCommand, REMOTE_COMMAND_QUEUE_SIZE> remoteCommands;
+
+void queueRemoteCommand(MqttCommand command, long value) {
+  remoteCommands.push({command, value});
+}
+
+#if ENABLE_ANIMATION_MODE || ENABLE_OTA
+// Flash writes and downloads stay on the I/O side, the render side only
+// reloads the stored animation
+bool storeUpload(MqttCommand command, const uint8_t* data, unsigned int length) {
+  switch (command) {
+#if ENABLE_ANIMATION_MODE
+    case COMMAND_ANIMATION:
+      return AnimationMode::save(data, length);
+#endif
+#if ENABLE_OTA
+    case COMMAND_UPDATE:
+      return otaService.start(data, length);
+#endif
+    default:
+      return false;
+  }
+}
+#endif
+#endif
+
+#if ENABLE_OTA
+void reportUpdate(const char* message) {
+  mqttService.systemStatus(message);
+}
+#endif
+#endif
 
 // ============================================================================
 //                           CONTROLLER AND MODES
 // ============================================================================
-Controller* controller;
-StaticMode* staticMode;
-WaveMode* waveMode;
-BlinkMode* blinkMode;
-HalfMode* halfMode;
-CenterMode* centerMode;
-ChaseMode* chaseMode;
+StaticMode staticMode(&lightService, &speakerService);
+WaveMode waveMode(&lightService, &speakerService);
+BlinkMode blinkMode(&lightService, &speakerService);
+HalfMode halfMode(&lightService, &speakerService);
+CenterMode centerMode(&lightService, &speakerService);
+ChaseMode chaseMode(&lightService, &speakerService);
+#if ENABLE_ANIMATION_MODE
+AnimationMode animationMode(&lightService, &speakerService);
+#endif
+
+// Play order, add new modes here
+AbstractMode* const modes[] = {
+  &staticMode,
+  &waveMode,
+  &blinkMode,
+  &halfMode,
+  &centerMode,
+  &chaseMode,
+#if ENABLE_ANIMATION_MODE
+  &animationMode,
+#endif
+};
+
+Controller controller(&sensorService, &speakerService, modes);
+#if ENABLE_IDLE_MODE
+PowerManager powerManager(&controller, &lightService);
+#endif
+
+#if ENABLE_DUAL_CORE
+void ioTask(void* parameter);
+#endif
 
 // ============================================================================
 //                              SETUP FUNCTION
 // ============================================================================
 void setup() {
-  // Ensure ESP is fully booted before starting
-  delay(1000);
-  
+  Profiler::setup();
+  MemoryMonitor::setup();
+#if ENABLE_IDLE_MODE
+  powerManager.setup();
+#endif
+
 #if ENABLE_SERIAL_DEBUG
   // Initialize Serial but don't wait for connection
   Serial.begin(115200);
@@ -72,80 +196,76 @@ void setup() {
 #endif
 #endif
 
-  // Initialize services with error handling (only output if Serial available)
-#if ENABLE_SERIAL_DEBUG
-  Serial.println("[INFO] Initializing LightService...");
+#if ENABLE_MQTT
+  // The service keeps the pointer, so the ID lives in static storage
+  snprintf(mqttClientId, sizeof(mqttClientId), "%s-%ld", MQTT_CLIENT_ID, random(10000, 99999));
+  mqttService.setBaseTopic(MQTT_BASE_TOPIC);
+#if ENABLE_MQTT_COMMANDS
+  mqttService.setCommandHandler(queueRemoteCommand);
+#if ENABLE_ANIMATION_MODE || ENABLE_OTA
+  mqttService.setUploadHandler(storeUpload);
 #endif
-  lightService = new LightService();
-  
-#if ENABLE_SERIAL_DEBUG
-  Serial.println("[INFO] Initializing SpeakerService...");
 #endif
-  speakerService = new SpeakerService();
-  
-#if ENABLE_SERIAL_DEBUG
-  Serial.println("[INFO] Initializing SensorService...");
+#if ENABLE_OTA
+  otaService.setStatusHandler(reportUpdate);
+#endif
 #endif
-  sensorService = new SensorService(SENSOR_PIN);
 
-#if ENABLE_MQTT
-  // Initialize MQTT service if enabled
-  String uniqueClientId = String(MQTT_CLIENT_ID) + "-" + String(random(10000, 99999));
-  mqttService = new MqttService(
-    WIFI_SSID, 
-    WIFI_PASSWORD,
-    MQTT_SERVER,
-    MQTT_PORT,
-    uniqueClientId.c_str(),
-    MQTT_USER,
-    MQTT_PASSWORD
-  );
-  mqttService->setBaseTopic(MQTT_BASE_TOPIC);
-#endif
-
-  // Setup services
-  lightService->setup();
-  speakerService->setup();
-  sensorService->setup();
+  // Stage 1: lights and sensor come up immediately
+  lightService.setup();
+  sensorService.setup();
 
 #if ENABLE_MQTT
-  if (mqttService) {
-    mqttService->setup();
-  }
+  controller.addObserver(&mqttEvents);
+#endif
+#if ENABLE_DONATION_STATS
+  donationStats.setup();
+  controller.addObserver(&donationStats);
+#endif
+#if ENABLE_IDLE_MODE
+  controller.addObserver(&powerManager);
+  sensorService.setEdgeNotifier(PowerManager::wakeFromIsr);
 #endif
 
-  // Create controller
-  controller = new Controller(sensorService, speakerService);
+  // Setup controller (this will activate the first mode)
+  lightService.beginFrame();
+  controller.setup();
+  lightService.commitFrame();
+  firstFrameTime = millis();
 
-  // Create and register modes
-  staticMode = new StaticMode(lightService, speakerService);
-  waveMode = new WaveMode(lightService, speakerService);
-  blinkMode = new BlinkMode(lightService, speakerService);
-  halfMode = new HalfMode(lightService, speakerService);
-  centerMode = new CenterMode(lightService, speakerService);
-  chaseMode = new ChaseMode(lightService, speakerService);
-  
-  controller->addMode(staticMode);
-  controller->addMode(waveMode);
-  controller->addMode(blinkMode);
-  controller->addMode(halfMode);
-  controller->addMode(centerMode);
-  controller->addMode(chaseMode);
+#if ENABLE_SERIAL_DEBUG
+  Serial.print("[INFO] Boot to first frame: ");
+  Serial.print(firstFrameTime);
+  Serial.println(" ms");
+#endif
 
-  // Setup controller (this will activate the first mode)
-  controller->setup();
+  // Stage 2: speaker and network initialize in the background from loop()
+  speakerService.setup();
 
 #if ENABLE_MQTT
-  // Send system startup notification
-  if (mqttService && mqttService->isConnected()) {
-    mqttService->systemStatus("Donation box system started successfully");
-    mqttService->logInfo("System initialized with " + String(controller->getModeCount()) + " LED modes");
-    mqttService->modeChanged("none", controller->getCurrentModeName());
-  }
+  mqttService.setup();
 #endif
 
-  // Initialize state tracking
-  lastModeName = controller->getCurrentModeName();
+#if ENABLE_SERIAL_CONSOLE
+  serialConsole.addCommand("mem", "Heap and stack watermarks", MemoryMonitor::print);
+#if ENABLE_DONATION_STATS
+  serialConsole.addCommand("stats", "Donation statistics", printStats);
+#endif
+#endif
+
+#if ENABLE_DUAL_CORE
+  // Rendering and sensor stay in loop() (Arduino core), I/O moves to the other core
+  TaskHandle_t ioTaskHandle = nullptr;
+  xTaskCreatePinnedToCore(ioTask, "io", IO_TASK_STACK_SIZE, nullptr,
+                          IO_TASK_PRIORITY, &ioTaskHandle, IO_TASK_CORE);
+  MemoryMonitor::setIoTask(ioTaskHandle);
+#if ENABLE_SERIAL_DEBUG
+  Serial.print("[INFO] Dual-core mode: render on core ");
+  Serial.print(xPortGetCoreID());
+  Serial.print(", I/O on core ");
+  Serial.println(IO_TASK_CORE);
+#endif
+#endif
 
 #if ENABLE_SERIAL_DEBUG
   Serial.println("[INFO] Setup complete. Donation box ready!");
@@ -153,41 +273,177 @@ void setup() {
 }
 
 // ============================================================================
-//                                MAIN LOOP
+//                              I/O SERVICES
 // ============================================================================
-void loop() {
-  // Update sensor service
-  sensorService->loop();
-  
+// Speaker and network handling. Runs inline in loop(), or with
+// ENABLE_DUAL_CORE as its own task next to the WiFi stack.
+void serviceIo() {
   // Update speaker service
-  speakerService->loop();
+  {
+    PROFILE_SCOPE(PROFILE_SPEAKER);
+    speakerService.loop();
+  }
   
 #if ENABLE_MQTT
   // Update MQTT service if enabled
-  if (mqttService) {
-    mqttService->loop();
+  {
+    PROFILE_SCOPE(PROFILE_MQTT);
+    mqttService.loop();
   }
 #endif
 
-  // Run controller logic
-  controller->loop();
-  
+#if ENABLE_MQTT && ENABLE_OTA
+  // One chunk of a running download per pass
+  otaService.loop();
+#endif
+
+#if ENABLE_SERIAL_CONSOLE
+  // Debug commands, printed from the I/O side so rendering never waits for the UART
+  serialConsole.loop();
+#endif
+
 #if ENABLE_MQTT
-  // Handle MQTT events based on controller state changes
-  if (mqttService && mqttService->isConnected()) {
-    
-    // Check for mode changes
-    String currentModeName = controller->getCurrentModeName();
-    if (currentModeName != lastModeName) {
-      mqttService->modeChanged(lastModeName, currentModeName);
-      lastModeName = currentModeName;
+  // Send system startup notification once the background connect succeeded
+  if (!startupAnnounced && mqttService.isConnected()) {
+    char message[80];
+    mqttService.systemStatus("Donation box system started successfully");
+    snprintf(message, sizeof(message), "System initialized with %u LED modes", controller.getModeCount());
+    mqttService.logInfo(message);
+    snprintf(message, sizeof(message), "Boot to first frame: %lu ms, online after %lu ms", firstFrameTime, millis());
+    mqttService.logInfo(message);
+    mqttService.modeChanged("none", controller.getCurrentModeName());
+    startupAnnounced = true;
+  }
+  
+  // Forward pushed Controller events (queued by MqttService while offline)
+  ControllerEvent event;
+  while (mqttEvents.events.pop(event)) {
+    if (event.donation) {
+      mqttService.donation(controller.getModeName(event.modeIndex), 1);
+    } else {
+      mqttService.modeChanged(controller.getModeName(event.fromIndex),
+                              controller.getModeName(event.modeIndex));
+    }
+  }
+  
+  if (mqttEvents.events.getDropped() != mqttEvents.reportedDrops) {
+    mqttEvents.reportedDrops = mqttEvents.events.getDropped();
+    mqttService.logWarning("Controller event queue overflowed, events were lost");
+  }
+
+#if ENABLE_DONATION_STATS
+  // Retained summary, at most once per interval however fast the coins come in
+  if (millis() - lastStatsPublish >= DONATION_STATS_PUBLISH_INTERVAL) {
+    DonationSummary stats;
+    donationStats.snapshot(stats);
+    if (stats.revision != publishedStatsRevision && mqttService.donationStats(stats)) {
+      publishedStatsRevision = stats.revision;
+      lastStatsPublish = millis();
+    }
+  }
+#endif
+#endif
+}
+
+#if ENABLE_MQTT && ENABLE_MQTT_COMMANDS
+// Runs on the render side, which owns the Controller, LightService and the speaker inbox
+void applyRemoteCommands() {
+  RemoteCommand remote;
+  while (remoteCommands.pop(remote)) {
+#if ENABLE_IDLE_MODE
+    powerManager.wake();
+#endif
+    switch (remote.command) {
+      case COMMAND_MODE:
+        if (!controller.switchToMode(remote.value)) {
+          Serial.println("[WARNING] Remote mode index out of range");
+        }
+        break;
+      case COMMAND_DONATION:
+        controller.triggerDonation();
+        break;
+      case COMMAND_VOLUME:
+        speakerService.setVolume(remote.value);
+        break;
+      case COMMAND_BRIGHTNESS:
+        lightService.setBrightnessLimit(remote.value);
+        break;
+      case COMMAND_ANIMATION:
+#if ENABLE_ANIMATION_MODE
+        animationMode.reload();
+#endif
+        break;
+      case COMMAND_UPDATE:
+        // Downloaded on the I/O side, the animation keeps running until the reboot
+        break;
     }
+  }
+}
+#endif
+
+#if ENABLE_DUAL_CORE
+void ioTask(void* parameter) {
+  (void)parameter;
+  for (;;) {
+    serviceIo();
+    // Let the idle task (watchdog) and the WiFi stack run
+    vTaskDelay(1);
+  }
+}
+#endif
+
+// ============================================================================
+//                                MAIN LOOP
+// ============================================================================
+void loop() {
+  {
+    PROFILE_SCOPE(PROFILE_LOOP);
     
-    // Send donation event if just detected
-    if (donationJustDetected) {
-      mqttService->donation(currentModeName, 1);
-      donationJustDetected = false;
+    // Collect all LED writes of this iteration into a single frame
+    lightService.beginFrame();
+
+    // Update sensor service
+    {
+      PROFILE_SCOPE(PROFILE_SENSOR);
+      sensorService.loop();
     }
+
+#if ENABLE_MQTT && ENABLE_MQTT_COMMANDS
+    applyRemoteCommands();
+#endif
+
+    // Run controller logic
+    {
+      PROFILE_SCOPE(PROFILE_CONTROLLER);
+      controller.loop();
+    }
+
+    // Push the frame to the strip (no-op if nothing changed)
+    lightService.commitFrame();
+
+#if ENABLE_DONATION_STATS
+    // Batched flash writes of the counters
+    donationStats.loop();
+#endif
+
+#if ENABLE_IDLE_MODE
+    powerManager.loop();
+#endif
+
+    // Track the lowest free heap (the ESP32 heap does this itself)
+    MemoryMonitor::sample();
+    
+#if !ENABLE_DUAL_CORE
+    serviceIo();
+#endif
+  }
+
+  // Nothing to render until the next frame, give the CPU and WiFi stack a break
+#if ENABLE_IDLE_MODE
+  powerManager.sleep(min(controller.timeUntilNextFrame(), lightService.timeUntilRefresh()));
+#else
+  if (controller.timeUntilNextFrame() > 0) {
+    delay(1);
   }
 #endif
 }
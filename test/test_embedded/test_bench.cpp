@@ -0,0 +1,61 @@
+// Budgets of the benchmark firmware as Unity tests on the board, every mode
+// is measured once after boot (see bench/README.md). Only the LED strip
+// should be connected.
+//
+//   pio test -e bench_esp32_dev
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "Bench.hpp"
+
+static BenchResult results[BENCH_MODE_COUNT];
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_frame_time_within_budget() {
+    for (uint8_t i = 0; i < BENCH_MODE_COUNT; i++) {
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, results[i].slowFrames, results[i].name);
+    }
+}
+
+void test_one_show_per_pass() {
+    for (uint8_t i = 0; i < BENCH_MODE_COUNT; i++) {
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, results[i].extraShows, results[i].name);
+    }
+}
+
+void test_edge_to_frame_within_budget() {
+    for (uint8_t i = 0; i < BENCH_MODE_COUNT; i++) {
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(BENCH_DONATIONS, results[i].coinsShown, results[i].name);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32_MESSAGE(BENCH_MAX_LATENCY_US, results[i].maxLatencyUs, results[i].name);
+    }
+}
+
+void test_no_heap_lost() {
+    for (uint8_t i = 0; i < BENCH_MODE_COUNT; i++) {
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(0, results[i].heapLost, results[i].name);
+    }
+}
+
+void setup() {
+    // Time for the test runner to open the serial port
+    Serial.begin(115200);
+    delay(2000);
+
+    benchSetup();
+    for (uint8_t i = 0; i < BENCH_MODE_COUNT; i++) {
+        benchMode(i, results[i]);
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_time_within_budget);
+    RUN_TEST(test_one_show_per_pass);
+    RUN_TEST(test_edge_to_frame_within_budget);
+    RUN_TEST(test_no_heap_lost);
+    UNITY_END();
+}
+
+void loop() {}
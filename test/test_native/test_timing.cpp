@@ -0,0 +1,195 @@
+// Timing guarantees of the render side, on the host with the simulator's
+// fakes (sim/src): at most one show() per loop pass, no steady refresh of a
+// static 8-bit brightness, a coin on the strip within one frame interval,
+// and no heap allocation once the loop runs.
+//
+//   pio test -e native
+
+#include <Arduino.h>
+#include <unity.h>
+#include <limits.h>
+
+#include "Controller.hpp"
+#include "LightService.hpp"
+#include "SpeakerService.hpp"
+#include "SensorService.hpp"
+
+#include "StaticMode.hpp"
+#include "WaveMode.hpp"
+#include "BlinkMode.hpp"
+#include "HalfMode.hpp"
+#include "CenterMode.hpp"
+#include "ChaseMode.hpp"
+#include "AnimationMode.hpp"
+
+#include "FrameRecorder.hpp"
+#include "ScriptedSensorInput.hpp"
+#include "RecordingAudioPlayer.hpp"
+#include "TimingChecks.hpp"
+
+// A coin waits at most one frame interval for its frame, plus the pass that shows it
+static const unsigned long MAX_EDGE_LATENCY_MS = 1000 / TARGET_FPS + 1;
+static const unsigned long COIN_MS = 80;
+
+// Counts the coins the Controller reports
+class DonationCounter : public ControllerObserver {
+    public:
+        unsigned long count = 0;
+        void onDonation(uint8_t modeIndex, unsigned long timestampMs) override { count++; }
+};
+
+// The services of src/main.cpp on fake hardware, with all seven modes
+struct Box {
+    FrameRecorder frameRecorder;
+    ScriptedSensorInput sensorInput;
+    RecordingAudioPlayer audioPlayer;
+
+    LightService lightService;
+    SpeakerService speakerService;
+    SensorService sensorService;
+
+    StaticMode staticMode;
+    WaveMode waveMode;
+    BlinkMode blinkMode;
+    HalfMode halfMode;
+    CenterMode centerMode;
+    ChaseMode chaseMode;
+    AnimationMode animationMode; // Built-in program
+    AbstractMode* const modes[7];
+
+    Controller controller;
+    TimingChecks checks;
+    DonationCounter donations;
+
+    Box()
+        : lightService(&frameRecorder), speakerService(&audioPlayer), sensorService(&sensorInput),
+          staticMode(&lightService, &speakerService), waveMode(&lightService, &speakerService),
+          blinkMode(&lightService, &speakerService), halfMode(&lightService, &speakerService),
+          centerMode(&lightService, &speakerService), chaseMode(&lightService, &speakerService),
+          animationMode(&lightService, &speakerService),
+          modes{&staticMode, &waveMode, &blinkMode, &halfMode, &centerMode, &chaseMode, &animationMode},
+          controller(&sensorService, &speakerService, modes),
+          checks(frameRecorder, modes, MAX_EDGE_LATENCY_MS) {
+        lightService.setup();
+        sensorService.setup();
+        controller.addObserver(&checks);
+        controller.addObserver(&donations);
+
+        lightService.beginFrame();
+        controller.setup();
+        lightService.commitFrame();
+        speakerService.setup();
+    }
+
+    // Loop passes of src/main.cpp in 1 ms ticks, the render side is checked
+    void run(unsigned long ms) {
+        unsigned long end = millis() + ms;
+        while (millis() < end) {
+            simAdvanceMillis(1);
+
+            checks.beginPass();
+            lightService.beginFrame();
+            sensorService.loop();
+            controller.loop();
+            lightService.commitFrame();
+            checks.endPass();
+
+            speakerService.loop();
+        }
+    }
+};
+
+void setUp() {
+    randomSeed(1);
+}
+
+void tearDown() {}
+
+void test_one_show_per_pass() {
+    Box box;
+    // Single coins and bursts, every third one bouncing
+    for (unsigned long t = 1000; t < 120000; t += 3000) {
+        unsigned long coins = t % 9000 == 1000 ? 3 : 1;
+        for (unsigned long coin = 0; coin < coins; coin++) {
+            unsigned long start = millis() + t + coin * 250;
+            if (coin % 3 == 2) {
+                box.sensorInput.addBouncyCoin(start, COIN_MS, 3);
+            } else {
+                box.sensorInput.addCoin(start, COIN_MS);
+            }
+        }
+    }
+    box.run(120000);
+
+    TEST_ASSERT_EQUAL_UINT32(120000, box.checks.getPasses());
+    TEST_ASSERT_EQUAL_UINT32(0, box.checks.getExtraShows());
+}
+
+void test_static_brightness_needs_no_refresh() {
+    FrameRecorder frameRecorder;
+    LightService lightService(&frameRecorder);
+    lightService.setup();
+    for (uint16_t level = 0; level <= 255; level++) {
+        lightService.beginFrame();
+        lightService.setBrightness(level);
+        lightService.commitFrame();
+        TEST_ASSERT_EQUAL_UINT32(ULONG_MAX, lightService.timeUntilRefresh());
+
+        // Nothing changes, nothing is shown
+        unsigned long frames = frameRecorder.getFrames();
+        for (uint8_t pass = 0; pass < 100; pass++) {
+            simAdvanceMillis(1);
+            lightService.beginFrame();
+            lightService.commitFrame();
+        }
+        TEST_ASSERT_EQUAL_UINT32(frames, frameRecorder.getFrames());
+    }
+
+    // A 16-bit level between two 8-bit steps is dithered
+    lightService.beginFrame();
+    lightService.setBrightness16(0x8080);
+    lightService.commitFrame();
+    TEST_ASSERT_TRUE(lightService.timeUntilRefresh() != ULONG_MAX);
+}
+
+void test_edge_to_effect_within_one_frame() {
+    Box box;
+    for (uint8_t i = 0; i < box.controller.getModeCount(); i++) {
+        // A coin on the idle animation of every mode, every other one bouncing
+        TEST_ASSERT_TRUE(box.controller.switchToMode(i));
+        unsigned long before = box.donations.count;
+        if (i % 2) {
+            box.sensorInput.addBouncyCoin(millis() + 500, COIN_MS, 3);
+        } else {
+            box.sensorInput.addCoin(millis() + 500, COIN_MS);
+        }
+        box.run(1000);
+
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(before + 1, box.donations.count, box.modes[i]->getName());
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, box.checks.getLateEdges(), box.modes[i]->getName());
+        box.run(5000); // Effect ends, the next mode starts
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(MAX_EDGE_LATENCY_MS, box.checks.getEdgeLatency());
+    TEST_ASSERT_EQUAL_UINT16(0, box.sensorService.getDroppedEdges());
+}
+
+void test_no_allocations_in_steady_state() {
+    Box box;
+    for (uint8_t i = 0; i < box.controller.getModeCount(); i++) {
+        // Idle animation, a coin, the effect and the switch to the next mode
+        TEST_ASSERT_TRUE(box.controller.switchToMode(i));
+        unsigned long before = box.checks.getAllocations();
+        box.sensorInput.addCoin(millis() + 2000, COIN_MS);
+        box.run(10000);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(before, box.checks.getAllocations(), box.modes[i]->getName());
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_one_show_per_pass);
+    RUN_TEST(test_static_brightness_needs_no_refresh);
+    RUN_TEST(test_edge_to_effect_within_one_frame);
+    RUN_TEST(test_no_allocations_in_steady_state);
+    return UNITY_END();
+}
@@ -0,0 +1,86 @@
+// Rolling hour of DonationStats on the host, against the simulated clock of
+// sim/src. DonationStats keeps nothing in flash under NATIVE.
+//
+//   pio test -e native
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include "DonationStats.hpp"
+
+static const unsigned long MINUTE_MS = 60000;
+
+// Simulated time to the start of the next minute plus offsetMs
+static void advanceToNextMinute(unsigned long offsetMs) {
+    simAdvanceMillis(MINUTE_MS - millis() % MINUTE_MS + offsetMs);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_counts_within_the_hour() {
+    DonationStats stats;
+    stats.setup();
+    for (uint8_t i = 0; i < 3; i++) {
+        advanceToNextMinute(1000);
+        stats.loop();
+        stats.onDonation(0, millis());
+    }
+
+    DonationSummary summary;
+    stats.snapshot(summary);
+    TEST_ASSERT_EQUAL_UINT32(3, summary.total);
+    TEST_ASSERT_EQUAL_UINT16(3, summary.lastHour);
+    TEST_ASSERT_EQUAL_UINT16(1, summary.peakMinute);
+}
+
+void test_late_edge_counts_in_current_minute() {
+    DonationStats stats;
+    stats.setup();
+    advanceToNextMinute(1000);
+    stats.loop();
+    stats.onDonation(0, millis());
+    stats.onDonation(0, millis());
+
+    // loop() has rotated to the next minute, the edge was stamped before it
+    advanceToNextMinute(5);
+    stats.loop();
+    stats.onDonation(1, millis() - MINUTE_MS);
+
+    DonationSummary summary;
+    stats.snapshot(summary);
+    TEST_ASSERT_EQUAL_UINT32(3, summary.total);
+    TEST_ASSERT_EQUAL_UINT16(3, summary.lastHour);
+
+    // The next rotation does not clear the window again
+    advanceToNextMinute(1000);
+    stats.loop();
+    stats.snapshot(summary);
+    TEST_ASSERT_EQUAL_UINT16(3, summary.lastHour);
+}
+
+void test_window_drops_donations_older_than_an_hour() {
+    DonationStats stats;
+    stats.setup();
+    advanceToNextMinute(1000);
+    stats.loop();
+    stats.onDonation(0, millis());
+
+    simAdvanceMillis(60 * MINUTE_MS);
+    stats.loop();
+
+    DonationSummary summary;
+    stats.snapshot(summary);
+    TEST_ASSERT_EQUAL_UINT32(1, summary.total);
+    TEST_ASSERT_EQUAL_UINT16(0, summary.lastHour);
+    TEST_ASSERT_EQUAL_UINT16(1, summary.peakHour);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_counts_within_the_hour);
+    RUN_TEST(test_late_edge_counts_in_current_minute);
+    RUN_TEST(test_window_drops_donations_older_than_an_hour);
+    return UNITY_END();
+}